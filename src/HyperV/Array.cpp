@@ -1 +1,45 @@
-#include "Array.hpp"
\ No newline at end of file
+#include "Array.hpp"
+
+namespace HyperV {
+
+/** Check CoordsIterator visit each element once, in memory order. */
+template<typename ARRAY>
+static void unitests_array_iterator()
+{
+	size_t count = 0;
+	for(auto [index, coords] : ARRAY::Coords()) {
+		ASSERT_ALWAYS(index == count, "Iterator must follow memory order.");
+		ASSERT_ALWAYS(ARRAY::IndexAt(coords) == index, "Iterator coordinates mismatch index.");
+		typename ARRAY::Coordinates decoded;
+		ARRAY::CoordsFor(decoded, index);
+		ASSERT_ALWAYS(Math::Equal<ARRAY::N>(decoded, coords), "Iterator coordinates mismatch CoordsFor.");
+		++count;
+	}
+	ASSERT_ALWAYS(count == ARRAY::SIZE, "Iterator must visit each element.");
+
+	// Sub range.
+	count = 0;
+	for(auto [index, coords] : ARRAY::Coords(ARRAY::SIZE/3, ARRAY::SIZE/2)) {
+		ASSERT_ALWAYS(index == ARRAY::SIZE/3 + count, "Sub range must follow memory order.");
+		ASSERT_ALWAYS(ARRAY::IndexAt(coords) == index, "Sub range coordinates mismatch index.");
+		++count;
+	}
+	ASSERT_ALWAYS(count == ARRAY::SIZE/2 - ARRAY::SIZE/3, "Sub range must visit each element.");
+}
+
+} // namespace HyperV
+
+void HyperV::unitests_array()
+{
+	unitests_array_iterator<SArray<uint8, 7>>();
+	unitests_array_iterator<SArray<uint8, 3, 5, 4>>();
+	unitests_array_iterator<SArray<uint8, 32, 32, 32>>();
+	unitests_array_iterator<SArray<uint8, 2, 3, 4, 5>>();
+	unitests_array_iterator<ZArray3D<uint8, 8>>();
+	unitests_array_iterator<UArray3D<uint8, 8>>();
+
+	// Index must not overflow on small element type.
+	using Array = SArray<uint8, 32, 32, 32>;
+	ASSERT_ALWAYS(Array::IndexAt(1, 2, 3) == 1 + 2*32 + 3*32*32, "S ordered index is wrong.");
+	ASSERT_ALWAYS(Array::IndexAt(Array::Coordinates{1, 2, 3}) == 1 + 2*32 + 3*32*32, "S ordered index is wrong.");
+}
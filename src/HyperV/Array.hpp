@@ -7,6 +7,7 @@
 
 #include <array>
 #include "Util.hpp"
+#include "Curve.hpp"
 
 namespace HyperV {
 
@@ -52,6 +53,9 @@ public:
 	/** Number of dimension for this array. */
 	static constexpr size_t N = sizeof...(DIMS);
 
+	/** Different elements can be written from different threads. */
+	static constexpr bool CONCURRENT_WRITES = true;
+
 	/**
 	 * Coordinate vector of indices
 	 * with the same number of dimension.
@@ -59,6 +63,21 @@ public:
 	 */
 	using Coordinates = std::array<size_t, N>;
 
+	/**
+	 * Number of bits per coordinate, for Z and U ordering.
+	 * Sides are powers of two for those ordering.
+	 */
+	static constexpr size_t BITS = Math::Log2(OpPack::Proj(0, DIMS...));
+
+	/** Width of the array on each axis. */
+	static constexpr Coordinates WIDTHS = {DIMS...};
+
+	/**
+	 * Distance in the one dimensional array between two neighbors
+	 * along each axis, for S_ORDERING.
+	 */
+	static constexpr Coordinates STRIDES = OpPack::PrefixMul(DIMS...);
+
 private:
 	/** One dimensional array. */
 	std::array<T, SIZE> elements;
@@ -73,8 +92,8 @@ private:
 			static_assert(sizeof...(coords) == 0, "Too much coords.");
 			return coord*prevMulDim;
 		} else {
-			T buffer = prevMulDim*OpPack::Proj(I, DIMS...);
-			return coord*prevMulDim + S_IndexAtPack<I+1, Pack...>(buffer, coords...);
+			size_t buffer = prevMulDim*OpPack::Proj(I, DIMS...);
+			return coord*prevMulDim + S_IndexAtPack<I+1>(buffer, coords...);
 		}
 	}
 
@@ -87,7 +106,7 @@ private:
 		if constexpr(I == (N-1))
 			return coords[I]*prevMulDim;
 		else {
-			T buffer = prevMulDim*OpPack::Proj(I, DIMS...);
+			size_t buffer = prevMulDim*OpPack::Proj(I, DIMS...);
 			return coords[I]*prevMulDim + S_IndexAtList<I+1>(buffer, coords);
 		}
 	}
@@ -99,14 +118,14 @@ public:
 	template<typename... Pack>
 	static inline size_t IndexAt(Pack... coords)
 	{
-		ASSERT(Math::Lower<N>(Coordinates{coords...}, Coordinates{DIMS...}), "Coordinates out of bounds.");
+		ASSERT_PARANOID(Math::Lower<N>(Coordinates{(size_t)coords...}, Coordinates{DIMS...}), "Coordinates out of bounds.");
 		static_assert(
 			sizeof...(coords) == N,
 			"You must give one coordinate for each dimension(s)."
 		);
 		if constexpr (INDEXING==IndexingMode::S_ORDERING) { return S_IndexAtPack<0>(1, coords...); }
-		else if constexpr (INDEXING==IndexingMode::Z_ORDERING) { ASSERT(false, "Not implemented yet."); return 0; }
-		else if constexpr (INDEXING==IndexingMode::U_ORDERING) { ASSERT(false, "Not implemented yet."); return 0; }
+		else if constexpr (INDEXING==IndexingMode::Z_ORDERING) { return Morton::Encode<N, BITS>(Coordinates{(size_t)coords...}); }
+		else if constexpr (INDEXING==IndexingMode::U_ORDERING) { return Hilbert::Encode<N, BITS>(Coordinates{(size_t)coords...}); }
 		else { ASSERT(false, "Unknow indexing."); return 0; }	
 	}
 
@@ -115,36 +134,41 @@ public:
 	 */
 	static inline size_t IndexAt(const Coordinates& coords)
 	{
-		ASSERT(Math::Lower<N>(coords, Coordinates{DIMS...}), "Coordinates out of bounds.");
+		ASSERT_PARANOID(Math::Lower<N>(coords, Coordinates{DIMS...}), "Coordinates out of bounds.");
 		if constexpr (INDEXING==IndexingMode::S_ORDERING) { return S_IndexAtList<0>(1, coords); }
-		else if constexpr (INDEXING==IndexingMode::Z_ORDERING) { ASSERT(false, "Not implemented yet."); return 0; }
-		else if constexpr (INDEXING==IndexingMode::U_ORDERING) { ASSERT(false, "Not implemented yet."); return 0; }
+		else if constexpr (INDEXING==IndexingMode::Z_ORDERING) { return Morton::Encode<N, BITS>(coords); }
+		else if constexpr (INDEXING==IndexingMode::U_ORDERING) { return Hilbert::Encode<N, BITS>(coords); }
 		else { ASSERT(false, "Unknow indexing."); return 0; }	
 	}
 
 	/**
 	 * Return coordinate for given index.
+	 * For S_ORDERING, strides and widths are compile time constants, so
+	 * divisions and modulos become shifts and masks for power of two
+	 * widths, and multiplications otherwise.
 	 */
 	template<size_t AXIS = N-1>
 	static Coordinates CoordsFor(Coordinates& coords, size_t index)
 	{
 		ASSERT(index < SIZE, "Index out of bounds.");
- 		if constexpr (AXIS == 0) {
-			coords[AXIS] = index % OpPack::Proj(0, DIMS...);
+		if constexpr (INDEXING==IndexingMode::Z_ORDERING) {
+			// Morton code decode every axis at once.
+			return Morton::Decode<N, BITS>(coords, index);
+		} else if constexpr (INDEXING==IndexingMode::U_ORDERING) {
+			// Hilbert index decode every axis at once.
+			return Hilbert::Decode<N, BITS>(coords, index);
 		} else {
-			size_t products = 1;
-			for(int m = 0; m < AXIS; ++m)
-				products *= WidthOf(m);
-			coords[AXIS] = index / products;
-			index -= (coords[AXIS] * products);
-		}
+			constexpr size_t stride = STRIDES[AXIS];
+			constexpr size_t width = WIDTHS[AXIS];
+			coords[AXIS] = (index / stride) % width;
 
-		// Calculate value for next axis.
-		if constexpr(AXIS > 0) CoordsFor<AXIS-1>(coords, index);
+			// Calculate value for next axis.
+			if constexpr(AXIS > 0) CoordsFor<AXIS-1>(coords, index);
 
-		// For conveniency we return the ref of the array.
-		ASSERT(Math::Lower<N>(coords, Coordinates{DIMS...}), "Coordinates out of bounds.");
-		return coords;
+			// For conveniency we return the ref of the array.
+			ASSERT_PARANOID(Math::Lower<N>(coords, WIDTHS), "Coordinates out of bounds.");
+			return coords;
+		}
 	}
 
 	/**
@@ -156,6 +180,67 @@ public:
 		return CoordsFor(coords, index);
 	}
 
+	/**
+	 * Iterator on each (index, coordinates) of the array, in memory order.
+	 * For S_ORDERING coordinates are incremented with a carry, without any
+	 * division. For Z and U ordering they are decoded from the index.
+	 */
+	class CoordsIterator {
+	private:
+		size_t _index;
+		Coordinates _coords;
+
+	public:
+		explicit CoordsIterator(size_t index) : _index(index), _coords{}
+		{
+			if(_index < SIZE) CoordsFor(_coords, _index);
+		}
+
+		inline size_t index() const { return _index; }
+		inline const Coordinates& coords() const { return _coords; }
+
+		/** Usable with structured binding : auto [index, coords]. */
+		inline std::pair<size_t, const Coordinates&> operator* () const
+		{
+			return {_index, _coords};
+		}
+
+		inline CoordsIterator& operator++ ()
+		{
+			++_index;
+			if constexpr (INDEXING==IndexingMode::S_ORDERING) {
+				for(size_t k = 0; k < N; ++k) {
+					if(++_coords[k] < WIDTHS[k]) break;
+					_coords[k] = 0;
+				}
+			} else if(_index < SIZE) {
+				CoordsFor(_coords, _index);
+			}
+			return *this;
+		}
+
+		inline bool operator!= (const CoordsIterator& other) const { return _index != other._index; }
+		inline bool operator== (const CoordsIterator& other) const { return _index == other._index; }
+	};
+
+	/** Range of CoordsIterator over [first, last[ indices. */
+	struct CoordsRange {
+		size_t first = 0;
+		size_t last = SIZE;
+		inline CoordsIterator begin() const { return CoordsIterator(first); }
+		inline CoordsIterator end() const { return CoordsIterator(last); }
+	};
+
+	/**
+	 * Iterate each (index, coordinates) of the array :
+	 * 		for(auto [index, coords] : NArray::Coords()) {...}
+	 */
+	static inline CoordsRange Coords(size_t first = 0, size_t last = SIZE)
+	{
+		ASSERT(first <= last && last <= SIZE, "Range out of bounds.");
+		return CoordsRange{first, last};
+	}
+
 	/** Get pointer to element at given coordinate. */
 	template<typename... Pack>
 	inline T* GetPointerAt(Pack... coords)
@@ -249,6 +334,18 @@ public:
 		return *GetPointerAt(coords...);
 	}
 
+	/** Set every element to the same value. */
+	inline void Fill(const T& value)
+	{
+		elements.fill(value);
+	}
+
+	/** Pointer to the one dimensional array. */
+	inline T* data() { return elements.data(); }
+
+	/** Pointer to the one dimensional array. */
+	inline const T* data() const { return elements.data(); }
+
 	/** Retun an iterator at the begin of the array. */
 	inline auto begin()
 	{
@@ -271,12 +368,6 @@ public:
 		"An array must be of dimension 1 or higher."
 	);
 
-	static_assert(
-		INDEXING != IndexingMode::Z_ORDERING &&
-		INDEXING != IndexingMode::U_ORDERING,
-		"Z_ORDERING and U_ORDERING not implemented yet."
-	);
-
 	static_assert(
 		INDEXING == IndexingMode::S_ORDERING ||
 		INDEXING == IndexingMode::Z_ORDERING ||
@@ -288,7 +379,7 @@ public:
 		INDEXING == IndexingMode::S_ORDERING ||
 		(
 			(INDEXING == IndexingMode::Z_ORDERING || INDEXING == IndexingMode::U_ORDERING) &&
-			OpPack::Eq(DIMS...) &&
+			OpPack::AllEqTo(OpPack::Proj(0, DIMS...), DIMS...) &&
 			Math::IsPowerOfTwo(OpPack::Proj(0, DIMS...))
 		),
 		"For Z, and U indexing to work, all side must be equal, and be a power of two."
@@ -298,6 +389,9 @@ public:
 
 #include "Array.inl"
 
+/** Unit test for NArray class. */
+void unitests_array();
+
 
 // Definition of commons types :
 
@@ -0,0 +1,277 @@
+/**
+ * \author Asso Corentin
+ * \Date May 4 2021
+ * \Desc Headless micro-benchmarks of the core : indexing, chunk's
+ * iteration, noises, procedural generation, edits, meshing and raycasts.
+ * Run "hyperv_bench [filter]" to only run benchmarks whose name contain filter.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Array.hpp"
+#include "Chunk.hpp"
+#include "ChunkAllocator.hpp"
+#include "Procedural.hpp"
+
+using namespace HyperV;
+
+/** Prevent the compiler from removing benchmarked code. */
+static volatile size_t sink;
+
+/** Only benchmarks whose name contain this are run. */
+static const char* filter = "";
+
+/**
+ * Run fun a few times, and print the best time per operation.
+ * - ops : Number of operations done by one call of fun.
+ */
+template<typename F>
+static void Bench(const std::string& name, size_t ops, F fun)
+{
+	using Clock = std::chrono::steady_clock;
+	constexpr size_t RUNS = 5;
+	if(name.find(filter) == std::string::npos) return;
+
+	fun(); // Warm up.
+	double best = std::numeric_limits<double>::max();
+	for(size_t r = 0; r < RUNS; ++r) {
+		auto start = Clock::now();
+		fun();
+		best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+	}
+	std::cout << name << "\t" << best/ops << " ns/op\t" << ops*1e3/best << " Mop/s" << std::endl;
+}
+
+/** Time encode (IndexAt) and decode (CoordsFor) of every element of an array. */
+template<typename ARRAY>
+static void BenchIndexing(const std::string& name)
+{
+	// Coordinates are generated in S order for every mode,
+	// so the encoders all get the same input.
+	typename ARRAY::Coordinates sizes;
+	for(size_t k = 0; k < ARRAY::N; ++k) sizes[k] = ARRAY::WidthOf(k);
+	std::vector<typename ARRAY::Coordinates> coords;
+	coords.reserve(ARRAY::SIZE);
+	Misc::NestedForLoops<ARRAY::N>([&](const typename ARRAY::Coordinates& c) {
+		coords.push_back(c);
+		NFL_LAST_CALL;
+	}, sizes);
+
+	Bench("indexing/encode/" + name, ARRAY::SIZE, [&coords]() {
+		size_t acc = 0;
+		for(const auto& c : coords) acc += ARRAY::IndexAt(c);
+		sink = acc;
+	});
+
+	Bench("indexing/decode/" + name, ARRAY::SIZE, []() {
+		size_t acc = 0;
+		for(size_t index = 0; index < ARRAY::SIZE; ++index) {
+			auto c = ARRAY::CoordsFor(index);
+			acc += c[0] + c[ARRAY::N-1];
+		}
+		sink = acc;
+	});
+}
+
+/** Default terrain's ground level, for procedural benchmarks. */
+template<typename L>
+static float GroundLevel(const VectorNf<3>& worldPos)
+{
+	return Procedural::PerlinNoise<2>(Vector2f(worldPos[0], worldPos[2]), Vector2f(0.1875f, 0.1875f), 7.0f, L())*2.0f + 4.0f;
+}
+
+/** Terrain with caves, in the spirit of the default terrain. */
+template<typename L>
+static uint8 Terrain(const VectorNf<3>& worldPos, float groundLevel)
+{
+	if(worldPos[1] > groundLevel) return 0;
+	const float caves = Procedural::PerlinNoise<3>(worldPos, Vector3f(0.1875f, 0.1875f, 0.1875f), 7.0f, L());
+	if(caves >= 0.75f) return 0;
+	return (groundLevel - worldPos[1] < 1) ? 1 : 3;
+}
+
+/** Time iteration, generation and meshing of a chunk. */
+template<typename CHUNK>
+static void BenchChunk(const std::string& name)
+{
+	using Coordinates = typename CHUNK::VoxelArray::Coordinates;
+	std::unique_ptr<CHUNK> chunk(new CHUNK(CHUNK::GetWidth()*0.5f));
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+	ThreadPool& pool = ThreadPool::GetGlobal();
+
+	Bench("chunk/fill/" + name, CHUNK::CAPACITY, [&chunk]() {
+		chunk->Fill(3);
+	});
+
+	Bench("chunk/iterate/" + name, CHUNK::CAPACITY, [&chunk]() {
+		size_t acc = 0;
+		for(auto [index, coords] : CHUNK::VoxelArray::Coords())
+			acc += chunk->GetVoxels()[index] + coords[1];
+		sink = acc;
+	});
+
+	auto perVoxel = [](const CHUNK&, const VectorNf<3> worldPos, const Coordinates&, uint8) {
+		return Terrain<Procedural::SinLattice>(worldPos, GroundLevel<Procedural::SinLattice>(worldPos));
+	};
+	auto column = [](const CHUNK&, const VectorNf<3> worldPos, const Coordinates&) {
+		return GroundLevel<Procedural::HashLattice>(worldPos);
+	};
+	auto voxel = [](const CHUNK&, const VectorNf<3> worldPos, const Coordinates&, uint8, float groundLevel) {
+		return Terrain<Procedural::HashLattice>(worldPos, groundLevel);
+	};
+
+	Bench("procedural/per-voxel/" + name, CHUNK::CAPACITY, [&]() { chunk->Procedural(perVoxel); });
+	Bench("procedural/per-voxel-parallel/" + name, CHUNK::CAPACITY, [&]() { chunk->Procedural(perVoxel, pool); });
+	Bench("procedural/column-hash/" + name, CHUNK::CAPACITY, [&]() { chunk->Procedural(column, voxel); });
+	Bench("procedural/column-hash-parallel/" + name, CHUNK::CAPACITY, [&]() { chunk->Procedural(column, voxel, pool); });
+
+	Bench("mesh/cubic/" + name, CHUNK::CAPACITY, [&]() {
+		sink = chunk->CubicMesh(voxelSet).getIndices().size();
+	});
+	Bench("mesh/greedy/" + name, CHUNK::CAPACITY, [&]() {
+		sink = chunk->GreedyMesh(voxelSet).getIndices().size();
+	});
+
+	// Rays from above the chunk, down to random points of its ground.
+	constexpr size_t N_RAYS = 256;
+	std::vector<std::pair<VectorNf<3>, VectorNf<3>>> rays;
+	const float half = CHUNK::GetWidth()*0.25f;
+	for(size_t r = 0; r < N_RAYS; ++r) {
+		const VectorNf<3> origin(((r*37)%N_RAYS)/(float)N_RAYS*half*2 - half, half*3, ((r*91)%N_RAYS)/(float)N_RAYS*half*2 - half);
+		const VectorNf<3> target(((r*53)%N_RAYS)/(float)N_RAYS*half*2 - half, -half, ((r*17)%N_RAYS)/(float)N_RAYS*half*2 - half);
+		rays.emplace_back(origin, (target - origin).normalized());
+	}
+	chunk->UpdateBrickOccupancy();
+	for(bool skip : {false, true}) {
+		Bench(std::string(skip ? "raycast/skip-bricks/" : "raycast/walk/") + name, N_RAYS, [&]() {
+			size_t acc = 0;
+			typename CHUNK::RayHit hit;
+			for(const auto& [origin, dir] : rays) acc += chunk->Raycast(origin, dir, 1000.0f, voxelSet, hit, skip);
+			sink = acc;
+		});
+	}
+
+	// Bulk edits, toggled so every call change voxels.
+	const VectorNf<3> a = VectorNf<3>::Constant(-CHUNK::GetWidth()*0.2f);
+	const VectorNf<3> b = VectorNf<3>::Constant(CHUNK::GetWidth()*0.2f);
+	uint8 stroke = 0;
+	Bench("edit/sphere/" + name, 1, [&]() { sink = chunk->DrawSphere(b, CHUNK::GetWidth()*0.125f, (stroke++ & 1) ? 0 : 4); });
+	Bench("edit/line/" + name, 1, [&]() { sink = chunk->DrawLine(a, b, 1.0f, (stroke++ & 1) ? 0 : 4); });
+
+	// A single voxel edited, then only the sections around it are meshed again.
+	SectionedMesh sections;
+	chunk->Remesh(voxelSet, sections);
+	size_t edit = 0;
+	Bench("mesh/remesh-edit/" + name, 1, [&]() {
+		Coordinates coords;
+		for(size_t n = 0; n < CHUNK::N; ++n) coords[n] = (edit*(7+2*n) + 3) % CHUNK::VoxelArray::WIDTHS[n];
+		chunk->SetVoxel(coords, (edit++ & 1) ? 0 : 4);
+		sink = chunk->Remesh(voxelSet, sections);
+	});
+
+	PackedSectionedMesh packed;
+	chunk->Remesh(voxelSet, packed);
+	Bench("mesh/remesh-edit-packed/" + name, 1, [&]() {
+		Coordinates coords;
+		for(size_t n = 0; n < CHUNK::N; ++n) coords[n] = (edit*(7+2*n) + 3) % CHUNK::VoxelArray::WIDTHS[n];
+		chunk->SetVoxel(coords, (edit++ & 1) ? 0 : 4);
+		sink = chunk->Remesh(voxelSet, packed);
+	});
+	if(std::string("mesh/bytes-per-quad/").find(filter) != std::string::npos && packed.GetQuadCount() > 0) {
+		std::cout << "mesh/bytes-per-quad/" << name << "\t" << sections.GetMemoryUsage()/sections.GetQuadCount()
+			<< " plain\t" << packed.GetMemoryUsage()/packed.GetQuadCount() << " packed" << std::endl;
+	}
+}
+
+/** Time Perlin noises of scattered N dimensional positions, one by one and batched. */
+template<size_t N>
+static void BenchNoise(const std::string& name)
+{
+	constexpr size_t COUNT = 1 << 14;
+	std::vector<VectorNf<N>> positions(COUNT);
+	for(size_t k = 0; k < COUNT; ++k)
+		for(size_t n = 0; n < N; ++n) positions[k][n] = Procedural::RNG(k + n*0.5f + 1.0f, 3.0f)*512.0f - 256.0f;
+	const VectorNf<N> cellPerUnit = VectorNf<N>::Constant(0.125f);
+	std::vector<float> noises(COUNT);
+
+	Bench("noise/perlin-hash/" + name, COUNT, [&]() {
+		float acc = 0;
+		for(size_t k = 0; k < COUNT; ++k) acc += Procedural::PerlinNoise<N>(positions[k], cellPerUnit, 7.0f, Procedural::HashLattice());
+		sink = (size_t)acc;
+	});
+	Bench("noise/batch-hash/" + name, COUNT, [&]() {
+		Procedural::PerlinNoiseBatch<N>(positions.data(), COUNT, cellPerUnit, 7.0f, noises.data(), Procedural::HashLattice());
+		sink = (size_t)noises[COUNT-1];
+	});
+}
+
+/** Time streaming churn : chunks are allocated, filled as a generator would, then freed. */
+template<typename CHUNK>
+static void BenchAlloc(const std::string& name)
+{
+	constexpr size_t COUNT = 64;
+	std::vector<ChunkPtr<CHUNK>> chunks;
+	chunks.reserve(COUNT);
+
+	Bench("alloc/new/" + name, COUNT, [&chunks]() {
+		for(size_t i = 0; i < COUNT; ++i) {
+			chunks.emplace_back(new CHUNK(16));
+			chunks.back()->Fill(i);
+		}
+		chunks.clear();
+	});
+
+	ChunkAllocator<CHUNK> allocator;
+	Bench("alloc/pool/" + name, COUNT, [&chunks, &allocator]() {
+		for(size_t i = 0; i < COUNT; ++i) {
+			chunks.push_back(allocator.Create(16));
+			chunks.back()->Fill(i);
+		}
+		chunks.clear();
+	});
+
+	ChunkAllocator<CHUNK> huge(true);
+	Bench("alloc/pool-huge/" + name, COUNT, [&chunks, &huge]() {
+		for(size_t i = 0; i < COUNT; ++i) {
+			chunks.push_back(huge.Create(16));
+			chunks.back()->Fill(i);
+		}
+		chunks.clear();
+	});
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc > 1) filter = argv[1];
+
+	BenchIndexing<SArray<uint8, 256, 256>>("S-2D-256");
+	BenchIndexing<ZArray2D<uint8, 256>>("Z-2D-256");
+	BenchIndexing<UArray2D<uint8, 256>>("U-2D-256");
+
+	BenchIndexing<SArray<uint8, 64, 64, 64>>("S-3D-64");
+	BenchIndexing<ZArray3D<uint8, 64>>("Z-3D-64");
+	BenchIndexing<UArray3D<uint8, 64>>("U-3D-64");
+
+	BenchIndexing<SArray<uint8, 16, 16, 16, 16>>("S-4D-16");
+	BenchIndexing<ZArray4D<uint8, 16>>("Z-4D-16");
+	BenchIndexing<UArray4D<uint8, 16>>("U-4D-16");
+
+	BenchChunk<Chunk16<uint8>>("16");
+	BenchChunk<Chunk32<uint8>>("32");
+	BenchChunk<Chunk64<uint8>>("64");
+	BenchChunk<ZChunk<32>>("Z-32");
+	BenchChunk<SparseChunk<32>>("sparse-32");
+
+	BenchNoise<2>("2D");
+	BenchNoise<3>("3D");
+	BenchNoise<4>("4D");
+
+	BenchAlloc<Chunk32<uint8>>("32");
+	BenchAlloc<Chunk64<uint8>>("64");
+	return 0;
+}
\ No newline at end of file
@@ -6,22 +6,22 @@ void HyperV::unitests_chunk()
 	// Empty chunk
 	chunk.Fill(0);
 	auto neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 0, "Neighbor POS_X should be empty.");
-	ASSERT(neighbors[NEG_X] == 0, "Neighbor NEG_X should be empty.");
-	ASSERT(neighbors[POS_Y] == 0, "Neighbor POS_Y should be empty.");
-	ASSERT(neighbors[NEG_Y] == 0, "Neighbor NEG_Y should be empty.");
-	ASSERT(neighbors[POS_Z] == 0, "Neighbor POS_Z should be empty.");
-	ASSERT(neighbors[NEG_Z] == 0, "Neighbor NEG_Z should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 0, "Neighbor POS_X should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 0, "Neighbor NEG_X should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 0, "Neighbor POS_Y should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 0, "Neighbor NEG_Y should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 0, "Neighbor POS_Z should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 0, "Neighbor NEG_Z should be empty.");
 
 	// Empty chunk
 	chunk.Fill(1);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// Testing each individual axis
 
@@ -29,67 +29,67 @@ void HyperV::unitests_chunk()
 	chunk.Fill(1);
 	chunk.SetVoxel({3, 2, 2}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 0, "Neighbor POS_X should be empty.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 0, "Neighbor POS_X should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// NEG_X
 	chunk.Fill(1);
 	chunk.SetVoxel({1, 2, 2}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 0, "Neighbor NEG_X should be empty.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 0, "Neighbor NEG_X should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 	
 	// POS_Y
 	chunk.Fill(1);
 	chunk.SetVoxel({2, 3, 2}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 0, "Neighbor POS_Y should be empty.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 0, "Neighbor POS_Y should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// NEG_Y
 	chunk.Fill(1);
 	chunk.SetVoxel({2, 1, 2}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 0, "Neighbor NEG_Y should be empty.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 0, "Neighbor NEG_Y should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// POS_Z
 	chunk.Fill(1);
 	chunk.SetVoxel({2, 2, 3}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 0, "Neighbor POS_Z should be empty.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 0, "Neighbor POS_Z should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// NEG_Z
 	chunk.Fill(1);
 	chunk.SetVoxel({2, 2, 1}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 0, "Neighbor NEG_Z should be empty.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 0, "Neighbor NEG_Z should be empty.");
 
 	// Testing each corner axis
 	chunk.Fill(1);
@@ -102,21 +102,223 @@ void HyperV::unitests_chunk()
 	chunk.SetVoxel({1, 3, 3}, 0);
 	chunk.SetVoxel({3, 3, 3}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
 
 	// Testing center
 	chunk.Fill(1);
 	chunk.SetVoxel({2, 2, 2}, 0);
 	neighbors = chunk.GetNeighborVoxels({2, 2, 2});
-	ASSERT(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
-	ASSERT(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
-	ASSERT(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
-	ASSERT(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
-	ASSERT(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
-	ASSERT(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+	ASSERT_ALWAYS(neighbors[POS_X] == 1, "Neighbor POS_X should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 1, "Neighbor NEG_Z should be full.");
+
+	// Z ordered chunk
+	ZChunk<4, uint8> zchunk(16);
+	zchunk.Fill(1);
+	zchunk.SetVoxel({3, 2, 2}, 0);
+	zchunk.SetVoxel({2, 2, 1}, 2);
+	neighbors = zchunk.GetNeighborVoxels({2, 2, 2});
+	ASSERT_ALWAYS(neighbors[POS_X] == 0, "Neighbor POS_X should be empty.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == 1, "Neighbor NEG_X should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == 1, "Neighbor POS_Y should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Y] == 1, "Neighbor NEG_Y should be full.");
+	ASSERT_ALWAYS(neighbors[POS_Z] == 1, "Neighbor POS_Z should be full.");
+	ASSERT_ALWAYS(neighbors[NEG_Z] == 2, "Neighbor NEG_Z should be 2.");
+	ASSERT_ALWAYS(zchunk.GetVoxel({2, 2, 1}) == 2, "Z ordered voxel was not stored.");
+
+	// Parallel procedural must give the same result as serial one.
+	auto gen = [](const Chunk16<uint8>&, const VectorNf<3> worldPos, const std::array<size_t, 3>& coords, const uint8 previousVoxelID) -> uint8 {
+		return (coords[0]*7 + coords[1]*3 + coords[2] + previousVoxelID + (worldPos[1] > 0)) % 5;
+	};
+	static Chunk16<uint8> serial(16), parallel(16);
+	ThreadPool pool(3);
+	serial.Fill(1);
+	parallel.Fill(1);
+	serial.Procedural(gen);
+	parallel.Procedural(gen, pool);
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords())
+		ASSERT_ALWAYS(serial.GetVoxel(coords) == parallel.GetVoxel(coords), "Parallel procedural differ from serial.");
+
+	// Greedy mesh of a flat plane is one quad per face.
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+	chunk.Fill(0);
+	for(auto [index, coords] : Chunk4<uint8>::VoxelArray::Coords())
+		if(coords[1] == 0) chunk.SetVoxel(coords, 1);
+	auto countFaces = [](const TriangleMesh& mesh, const Vector3f& normal) {
+		size_t count = 0;
+		for(const auto& n : mesh.normals()) count += (n == normal);
+		return count/4;
+	};
+	TriangleMesh greedy = chunk.GreedyMesh(voxelSet);
+	TriangleMesh cubic = chunk.CubicMesh(voxelSet);
+	ASSERT_ALWAYS(countFaces(greedy, Vector3f(0, 1, 0)) == 1, "Greedy mesh must merge coplanar faces.");
+	ASSERT_ALWAYS(countFaces(greedy, Vector3f(0, -1, 0)) == 1, "Greedy mesh must merge coplanar faces.");
+	ASSERT_ALWAYS(greedy.getIndices().size() == 6*2, "Greedy mesh of a plane must be a box.");
+	ASSERT_ALWAYS(greedy.getIndices().size() < cubic.getIndices().size(), "Greedy mesh must have less triangles.");
+
+	// Different voxels must not be merged.
+	chunk.SetVoxel({0, 0, 0}, 2);
+	greedy = chunk.GreedyMesh(voxelSet);
+	ASSERT_ALWAYS(countFaces(greedy, Vector3f(0, 1, 0)) == 3, "Greedy mesh must not merge different voxels.");
+
+	// Hidden faces must be culled, only the shell of a full chunk is visible.
+	chunk.Fill(3);
+	cubic = chunk.CubicMesh(voxelSet);
+	ASSERT_ALWAYS(cubic.getIndices().size() == 6*4*4*2, "Faces between opaque voxels must be culled.");
+	chunk.SetVoxel({1, 1, 1}, 0);
+	cubic = chunk.CubicMesh(voxelSet);
+	ASSERT_ALWAYS(cubic.getIndices().size() == (6*4*4+6)*2, "Faces around a hole must be visible.");
+
+	// Copied set must still answer for its own voxels.
+	VoxelSet<uint8> copy = voxelSet;
+	copy.Set(0, Voxel<uint8>("Glass", true, Colorf(1.0f, 1.0f, 1.0f), 0.0f));
+	ASSERT_ALWAYS(copy.Get(3).isFaceVisible(0) == false, "Copied voxels must use the copied set.");
+	ASSERT_ALWAYS(voxelSet.Get(3).isFaceVisible(0) == true, "Original set must be untouched.");
+
+	// Two stages procedural call the column stage once per column.
+	std::atomic<size_t> nColumnCalls(0);
+	auto groundLevel = [&nColumnCalls](const Chunk16<uint8>&, const VectorNf<3>& worldPos, const std::array<size_t, 3>& coords) {
+		++nColumnCalls;
+		return (float)((coords[0] + 2*coords[2]) % 5) + worldPos[0]*0.0f;
+	};
+	auto ground = [](const Chunk16<uint8>&, const VectorNf<3>&, const std::array<size_t, 3>& coords, uint8, float level) -> uint8 {
+		return (coords[1] < level) ? 3 : 0;
+	};
+	auto groundDirect = [](const Chunk16<uint8>&, const VectorNf<3>&, const std::array<size_t, 3>& coords, uint8) -> uint8 {
+		return (coords[1] < (float)((coords[0] + 2*coords[2]) % 5)) ? 3 : 0;
+	};
+	serial.Procedural(groundDirect);
+	parallel.Procedural(groundLevel, ground);
+	ASSERT_ALWAYS(nColumnCalls == 16*16, "Column stage must run once per column.");
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords())
+		ASSERT_ALWAYS(serial.GetVoxel(coords) == parallel.GetVoxel(coords), "Two stages procedural differ from direct one.");
+	parallel.Fill(0);
+	parallel.Procedural(groundLevel, ground, pool);
+	ASSERT_ALWAYS(nColumnCalls == 2*16*16, "Parallel column stage must run once per column.");
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords())
+		ASSERT_ALWAYS(serial.GetVoxel(coords) == parallel.GetVoxel(coords), "Parallel two stages procedural differ from direct one.");
+
+	// Coarse fields interpolate linear functions exactly.
+	auto linear = [](const VectorNf<3>& worldPos) { return worldPos[0]*2.0f - worldPos[1] + worldPos[2]*0.5f; };
+	static Chunk16<uint8>::CoarseArray<4> coarse, coarseNext;
+	Chunk16<uint8> left(16), right(16, Vector3f(16, 0, 0));
+	left.SampleCoarse<4>(coarse, linear);
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords()) {
+		const float expected = linear(left.GetWorldPos(coords));
+		ASSERT_ALWAYS(std::abs(Chunk16<uint8>::InterpolateCoarse<4>(coarse, coords) - expected) < 1e-3f, "Coarse field must interpolate linear functions exactly.");
+	}
+
+	// Chunks next to each other share the nodes of their border.
+	left.SampleCoarse<4>(coarse, linear, pool);
+	right.SampleCoarse<4>(coarseNext, linear, pool);
+	for(size_t j = 0; j <= 4; ++j)
+		for(size_t k = 0; k <= 4; ++k)
+			ASSERT_ALWAYS(coarse(4, j, k) == coarseNext(0, j, k), "Coarse fields must join on chunks borders.");
+
+	// Edits make only the bricks around them stale.
+	{
+		using EditChunk = Chunk32<uint8>;
+		static EditChunk edited(32);
+		VoxelSet<uint8> editSet = VoxelSet<uint8>::GenDefaultSet();
+		static_assert(EditChunk::N_BRICKS == 8, "Chunk32 must have 2x2x2 bricks.");
+		edited.Fill(0);
+		edited.SetVoxel({5, 5, 5}, 3);
+		SectionedMesh sections;
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 8, "First remesh must build every section.");
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 0, "Sections without edits must be kept.");
+		ASSERT_ALWAYS(sections.GetQuadCount() == 6, "Single voxel must be meshed with 6 faces.");
+
+		const uint64 generation = edited.GetGeneration();
+		edited.SetVoxel({20, 21, 22}, 3);
+		ASSERT_ALWAYS(edited.GetGeneration() > generation, "Edits must increase the generation.");
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 1, "Edit inside a brick must rebuild its section only.");
+		edited.SetVoxel({16, 15, 7}, 3);
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 3, "Edit on brick borders must rebuild the sections next to it.");
+
+		// Spliced sections hold the same faces than the whole mesh.
+		SectionedMesh cubic;
+		edited.Remesh(editSet, cubic, false);
+		ASSERT_ALWAYS(cubic.ToTriangleMesh().getIndices().size() == edited.CubicMesh(editSet).getIndices().size(), "Cubic sections must match the cubic mesh.");
+		ASSERT_ALWAYS(sections.ToTriangleMesh().getIndices().size() == 3*6*2, "Greedy sections must match the edits.");
+
+		// Packed sections unpack into the same faces than plain ones.
+		const uint32 vertex = PackedMeshBuilder::Pack({127, 0, 64}, NEG_Y, 255);
+		ASSERT_ALWAYS((PackedMeshBuilder::UnpackLattice(vertex) == PackedMeshBuilder::Lattice{127, 0, 64}), "Packed lattice position must be kept.");
+		ASSERT_ALWAYS(PackedMeshBuilder::UnpackFace(vertex) == NEG_Y && PackedMeshBuilder::UnpackVoxelID(vertex) == 255, "Packed face and voxel ID must be kept.");
+		ASSERT_ALWAYS(PackedMeshBuilder::UnpackNormal(vertex) == Vector3f(0, -1, 0), "Face must give the normal.");
+		const std::string decode = PackedMeshBuilder::GlslDecode();
+		ASSERT_ALWAYS(decode.find("& " + std::to_string(PackedMeshBuilder::COORD_MASK) + "u") != std::string::npos && decode.find(">> " + std::to_string(PackedMeshBuilder::ID_SHIFT) + "u") != std::string::npos, "Shaders must decode the packing of the vertices.");
+
+		PackedSectionedMesh packed;
+		ASSERT_ALWAYS(edited.Remesh(editSet, packed) == 8, "First packed remesh must build every section.");
+		ASSERT_ALWAYS(packed.GetQuadCount() == sections.GetQuadCount(), "Packed sections must hold the same quads.");
+		ASSERT_ALWAYS(packed.GetMemoryUsage() < sections.GetMemoryUsage(), "Packed sections must be smaller.");
+		const TriangleMesh plainMesh = sections.ToTriangleMesh();
+		const TriangleMesh packedMesh = packed.ToTriangleMesh([&editSet](size_t voxelID) { return editSet.Get(voxelID).color; });
+		ASSERT_ALWAYS(plainMesh.vertices().size() == packedMesh.vertices().size(), "Packed sections must unpack every vertex.");
+		for(size_t v = 0; v < plainMesh.vertices().size(); ++v) {
+			ASSERT_ALWAYS(plainMesh.vertices()[v].isApprox(packedMesh.vertices()[v]), "Packed vertices must unpack at the same place.");
+			ASSERT_ALWAYS(plainMesh.normals()[v] == packedMesh.normals()[v], "Packed faces must unpack to the same normals.");
+		}
+		for(size_t s = 0; s < EditChunk::N_BRICKS; ++s)
+			ASSERT_ALWAYS(packed.GetBox(s).isApprox(sections.GetBox(s)) || (packed.GetBox(s).isEmpty() && sections.GetBox(s).isEmpty()), "Packed sections must have the same boxes.");
+	}
+
+	// Bulk edits set the voxels whose center is inside the shape, and record the edit once.
+	{
+		using EditChunk = Chunk32<uint8>;
+		static EditChunk edited(32);
+		VoxelSet<uint8> editSet = VoxelSet<uint8>::GenDefaultSet();
+		SectionedMesh sections;
+		edited.Fill(0);
+		edited.Remesh(editSet, sections);
+
+		// Voxel (20, 20, 20) is centered on (4.5, 4.5, 4.5).
+		ASSERT_ALWAYS(edited.DrawSphere(Vector3f(4.5f, 4.5f, 4.5f), 2.0f, 3) == 33, "Sphere of radius 2 must hold 33 voxels.");
+		ASSERT_ALWAYS(edited.GetVoxel({22, 20, 20}) == 3 && edited.GetVoxel({22, 21, 20}) == 0, "Sphere must hold voxels inside it only.");
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 1, "Sphere inside a brick must rebuild its section only.");
+		const uint64 generation = edited.GetGeneration();
+		ASSERT_ALWAYS(edited.DrawSphere(Vector3f(4.5f, 4.5f, 4.5f), 2.0f, 3) == 0, "Drawing again must not change voxels.");
+		ASSERT_ALWAYS(edited.GetGeneration() == generation, "Drawing without change must not record an edit.");
+
+		ASSERT_ALWAYS(edited.DrawBox(Vector3f(-16, -16, -16), Vector3f(-13, -13, -13), 3) == 27, "Box must hold the voxels centered in it.");
+		ASSERT_ALWAYS(edited.DrawBox(Vector3f(-40, -40, -40), Vector3f(-17, 40, 40), 3) == 0, "Box outside the chunk must not change voxels.");
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 1, "Box in a corner must rebuild its section only.");
+		edited.DrawBox(Vector3f(-1, -1, -1), Vector3f(0, 0, 0), 3);
+		ASSERT_ALWAYS(edited.Remesh(editSet, sections) == 8, "Box on the border of bricks must rebuild the sections next to it.");
+
+		// Capsule narrows from A to B.
+		edited.Fill(0);
+		edited.DrawCapsule(Vector3f(-8.5f, 0.5f, 0.5f), 3.0f, Vector3f(7.5f, 0.5f, 0.5f), 0.0f, 3);
+		ASSERT_ALWAYS(edited.GetVoxel({7, 18, 16}) == 3, "Capsule must be wide next to A.");
+		ASSERT_ALWAYS(edited.GetVoxel({23, 18, 16}) == 0 && edited.GetVoxel({23, 16, 16}) == 3, "Capsule must be thin next to B.");
+
+		// Thin lines have no gaps.
+		edited.Fill(0);
+		edited.DrawLine(Vector3f(-13.5f, -13.5f, -13.5f), Vector3f(13.5f, 4.5f, -4.5f), 0.0f, 3);
+		ASSERT_ALWAYS(edited.GetVoxel({2, 2, 2}) == 3 && edited.GetVoxel({29, 20, 11}) == 3, "Line must hold its ends.");
+		for(size_t x = 2; x <= 29; ++x) {
+			bool hit = false;
+			for(size_t y = 0; y < 32 && !hit; ++y)
+				for(size_t z = 0; z < 32 && !hit; ++z)
+					hit = edited.GetVoxel({x, y, z}) == 3;
+			ASSERT_ALWAYS(hit, "Line must have no gaps.");
+		}
+	}
+
+	// Bulk edits work in any dimension.
+	{
+		using Chunk4D = Chunk<IndexingMode::S_ORDERING, uint8, 8, 8, 8, 8>;
+		static Chunk4D hyper(8);
+		hyper.Fill(0);
+		ASSERT_ALWAYS(hyper.DrawSphere(VectorNf<4>::Constant(0.5f), 1.0f, 3) == 9, "4D sphere of radius 1 must hold 9 voxels.");
+	}
 }
\ No newline at end of file
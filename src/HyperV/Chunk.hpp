@@ -6,19 +6,48 @@
 #pragma once
 
 #include "Array.hpp"
+#include "MeshBuilder.hpp"
+#include "PaletteArray.hpp"
+#include "Raycast.hpp"
+#include "RunLength.hpp"
+#include "ThreadPool.hpp"
 #include "VoxelSet.hpp"
 
 #include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 namespace HyperV {
 
+/** Integer coordinates of a chunk on the grid of a terrain. */
+template<size_t N>
+using GridCoords = std::array<int64, N>;
+
+/** Hash of grid coordinates, for unordered containers. */
+template<size_t N>
+struct GridCoordsHash {
+	inline size_t operator() (const GridCoords<N>& coords) const
+	{
+		size_t hash = 0;
+		for(size_t n = 0; n < N; ++n)
+			hash = (hash ^ (uint64)coords[n]) * 0x100000001B3UL;
+		return hash;
+	}
+};
+
 /**
  * A chunk is relative to a terrain and tile it.
  * Chunk definition is complely versatile, they can be from any dimension,
- * size, type of VoxelSet, or mode of indexing storage.
+ * size, type of VoxelSet, mode of indexing, or kind of storage.
+ * STORAGE is the array template holding the voxels : NArray store them
+ * plainly, PaletteArray compress them.
  */
-template<IndexingMode::Enum INDEXING, typename VOXELSET_SIZE_T, size_t... DIMS>
-class Chunk {
+template<template<IndexingMode::Enum, typename, size_t...> class STORAGE, IndexingMode::Enum INDEXING, typename VOXELSET_SIZE_T, size_t... DIMS>
+class BasicChunk {
 public:
 	/** Say the number of dimension for this chunk. */
 	static constexpr size_t N = sizeof...(DIMS);
@@ -26,8 +55,25 @@ public:
 	/** Total number of voxel the chunk can store. */
 	static constexpr size_t CAPACITY = OpPack::Mul(DIMS...); 
 
+	/** Type of the ID of voxels in the VoxelSet. */
+	using VoxelID = VOXELSET_SIZE_T;
+
+	/**
+	 * Width of a brick along each axis. Bricks tile the chunk, they are the
+	 * unit of edit tracking and of mesh sections.
+	 */
+	static constexpr std::array<size_t, N> BRICK_WIDTHS = {std::min(DIMS, (size_t)16)...};
+
+	/** Number of bricks along each axis. */
+	static constexpr std::array<size_t, N> BRICK_COUNTS = {(DIMS / std::min(DIMS, (size_t)16))...};
+
+	/** Number of bricks in the chunk. */
+	static constexpr size_t N_BRICKS = OpPack::Mul((DIMS / std::min(DIMS, (size_t)16))...);
+
+	static_assert(!OpPack::HasValue(true, (DIMS % std::min(DIMS, (size_t)16) != 0)...), "Width of the chunk must be a multiple of the brick's one.");
+
 	/** Shortcut for the type of the array where are stored voxels. */
-	using VoxelArray = NArray<INDEXING, VOXELSET_SIZE_T, DIMS...>;
+	using VoxelArray = STORAGE<INDEXING, VOXELSET_SIZE_T, DIMS...>;
 
 private:
 	/** The array were are stored the voxels. */
@@ -51,16 +97,89 @@ private:
 	/** Depend from _isFreeChunk : */
 	union {
 		/** If is not free chunk : coordinate relative to terrain. */
-		//Vector<size_t, N> _gridCoords;
+		GridCoords<N> _gridCoords;
 
 		/** If is free chunk : transformation relative to terrain. */
 		//Ra::Core::Transform _transform;
 	};
 
+	/** Generation of the last edit of the chunk, increased by each edit. */
+	uint64 _generation = 0;
+
+	/** Generation of the last edit of each brick. */
+	std::array<uint64, N_BRICKS> _brickGenerations{};
+
+	/** Bricks holding a voxel other than air, as of the generation _occupancyGeneration. */
+	std::bitset<N_BRICKS> _occupiedBricks;
+	uint64 _occupancyGeneration = std::numeric_limits<uint64>::max();
+
+	/** Faces of the chunk, in E_NEIGHBOR order, holding voxels edited since TakeEditedFaces. */
+	std::bitset<N*2> _editedFaces;
+
+	/** Record the edit of the voxels [lo, hi[ on the faces of the chunk they touch. */
+	inline void MarkFacesEdited(const typename VoxelArray::Coordinates& lo, const typename VoxelArray::Coordinates& hi)
+	{
+		for(size_t n = 0; n < N; ++n) {
+			if(hi[n] == VoxelArray::WIDTHS[n]) _editedFaces.set(n*2+0);
+			if(lo[n] == 0) _editedFaces.set(n*2+1);
+		}
+	}
+
+	/** Record the edit of a voxel, faces of the voxels next to it, maybe in another brick, can change. */
+	inline void MarkDirty(const typename VoxelArray::Coordinates& coords)
+	{
+		++_generation;
+		_brickGenerations[BrickOf(coords)] = _generation;
+		MarkFacesEdited(coords, Math::AddScalar<N>(coords, 1));
+		for(size_t n = 0; n < N; ++n) {
+			const size_t inBrick = coords[n] % BRICK_WIDTHS[n];
+			typename VoxelArray::Coordinates next = coords;
+			if(inBrick == 0 && coords[n] > 0) {
+				--next[n];
+				_brickGenerations[BrickOf(next)] = _generation;
+				next[n] = coords[n];
+			}
+			if(inBrick == BRICK_WIDTHS[n]-1 && coords[n]+1 < VoxelArray::WIDTHS[n]) {
+				++next[n];
+				_brickGenerations[BrickOf(next)] = _generation;
+			}
+		}
+	}
+
+	/**
+	 * Record the edit of the voxels of the box [lo, hi[, at once. Bricks
+	 * next to the box are marked too, when the box touch their border.
+	 */
+	inline void MarkDirty(const typename VoxelArray::Coordinates& lo, const typename VoxelArray::Coordinates& hi)
+	{
+		++_generation;
+		MarkFacesEdited(lo, hi);
+		typename VoxelArray::Coordinates first, sizes;
+		for(size_t n = 0; n < N; ++n) {
+			first[n] = (lo[n] > 0 ? lo[n]-1 : 0)/BRICK_WIDTHS[n];
+			sizes[n] = std::min(hi[n], VoxelArray::WIDTHS[n]-1)/BRICK_WIDTHS[n] + 1 - first[n];
+		}
+		Misc::NestedForLoops<N>([this, &first](const typename VoxelArray::Coordinates& local) {
+			size_t brick = 0;
+			for(size_t n = N; n-- > 0;) brick = brick*BRICK_COUNTS[n] + first[n] + local[n];
+			_brickGenerations[brick] = _generation;
+			NFL_LAST_CALL;
+		}, sizes);
+	}
+
+	/** Record the edit of every voxel. */
+	inline void MarkAllDirty()
+	{
+		++_generation;
+		_brickGenerations.fill(_generation);
+		_editedFaces.set();
+	}
+
 public:
 
-	/** Define world's size voxel. */
-	Chunk(float worldSize)
+	/** Define world's size voxel, and world position of the center of the chunk. */
+	BasicChunk(float worldSize, const VectorNf<N>& worldPos = VectorNf<N>::Zero())
+	: _worldPos(worldPos), _gridCoords()
 	{
 		_voxelSize = worldSize/OpPack::Proj(0, DIMS...);
 		_halfVoxelSize = _voxelSize*0.5f;
@@ -68,12 +187,154 @@ public:
 		_halfChunkWorldSize = _chunkWorldSize*0.5f;
 	}
 
+	/** Get world position of the center of the chunk. */
+	inline const VectorNf<N>& GetPosition() const { return _worldPos; }
+
+	/** World position of the corner of lowest coordinates. */
+	inline VectorNf<N> GetOrigin() const { return _worldPos - VectorNf<N>::Constant(_halfChunkWorldSize); }
+
+	/** Set world position of the center of the chunk. */
+	inline void SetPosition(const VectorNf<N>& worldPos) { _worldPos = worldPos; }
+
+	/** Get coordinates of the chunk on the grid of its terrain. */
+	inline const GridCoords<N>& GetGridCoords() const { return _gridCoords; }
+
+	/** Set coordinates of the chunk on the grid of its terrain. */
+	inline void SetGridCoords(const GridCoords<N>& coords) { _gridCoords = coords; }
+
+	/** Get world size of the chunk, on each axis. */
+	inline float GetWorldSize() const { return _chunkWorldSize; }
+
 	/** Number of neightbor per voxel. */
 	static constexpr size_t N_NEIGHBOR = N*2;
 
 	/** List who store neighbor voxel. */
 	using ListNeighbor = std::array<VOXELSET_SIZE_T, N_NEIGHBOR>;
 
+	/**
+	 * Read only views of the neighbors chunks, in the same order than
+	 * E_NEIGHBOR. nullptr when there is no chunk.
+	 */
+	using NeighborChunks = std::array<const BasicChunk*, N_NEIGHBOR>;
+
+	/**
+	 * Copy of the voxels of the chunk, padded with a border of one voxel
+	 * copied from the neighbors chunks. Neighbors of any voxel of the chunk
+	 * are then inside the apron, and can be read without any test.
+	 */
+	using ApronArray = SArray<VOXELSET_SIZE_T, (DIMS+2)...>;
+
+	/**
+	 * Field sampled every STEP voxels on each axis, the last sample of each
+	 * axis is the first voxel of the next chunk.
+	 * Chunks on a terrain's grid sample their shared border at the same
+	 * world positions, so interpolated fields join without seams.
+	 */
+	template<size_t STEP>
+	using CoarseArray = SArray<float, (DIMS/STEP+1)...>;
+
+	/**
+	 * Copy of the layers of voxels of the neighbors chunks touching this
+	 * one, in the same order than E_NEIGHBOR, empty when there is no chunk.
+	 * Unlike NeighborChunks, it can be read while the neighbors change.
+	 */
+	using NeighborFaces = std::array<std::vector<VOXELSET_SIZE_T>, N_NEIGHBOR>;
+
+	/** Walk the voxels of the face orthogonal to axis n, giving their coordinates on the face (0 along n). */
+	template<typename F>
+	static inline void ForEachOnFace(size_t n, F fun)
+	{
+		typename VoxelArray::Coordinates faceSizes = VoxelArray::WIDTHS;
+		faceSizes[n] = 1;
+		Misc::NestedForLoops<N>([&fun](const typename VoxelArray::Coordinates& coords) {
+			fun(coords);
+			NFL_LAST_CALL;
+		}, faceSizes);
+	}
+
+	/** Copy the layers of the neighbors touching a chunk : the first one of a positive neighbor, the last one of a negative neighbor. */
+	static NeighborFaces CopyNeighborFaces(const NeighborChunks& neighbors)
+	{
+		NeighborFaces faces;
+		for(size_t face = 0; face < N_NEIGHBOR; ++face) {
+			const BasicChunk* neighbor = neighbors[face];
+			if(neighbor == nullptr) continue;
+			const size_t n = face/2;
+			faces[face].reserve(CAPACITY/VoxelArray::WIDTHS[n]);
+			ForEachOnFace(n, [&](typename VoxelArray::Coordinates src) {
+				src[n] = (face%2 == 0) ? 0 : VoxelArray::WIDTHS[n]-1;
+				faces[face].push_back(neighbor->_voxels(src));
+			});
+		}
+		return faces;
+	}
+
+	/** Copy voxels of this chunk, and the layers of its neighbors into an apron. */
+	void FillApron(ApronArray& apron, const NeighborFaces& faces) const
+	{
+		constexpr VOXELSET_SIZE_T defaultVoxelID = 0;
+		std::fill(apron.begin(), apron.end(), defaultVoxelID);
+
+		for(auto [index, coords] : VoxelArray::Coords())
+			apron(Math::AddScalar<N>(coords, 1)) = _voxels[index];
+
+		for(size_t face = 0; face < N_NEIGHBOR; ++face) {
+			if(faces[face].empty()) continue;
+			ASSERT(faces[face].size() == CAPACITY/VoxelArray::WIDTHS[face/2], "Face of a neighbor doesn't match the chunk.");
+			const size_t n = face/2;
+			auto voxel = faces[face].begin();
+			ForEachOnFace(n, [&](const typename VoxelArray::Coordinates& coords) {
+				typename VoxelArray::Coordinates dst = Math::AddScalar<N>(coords, 1);
+				dst[n] = (face%2 == 0) ? VoxelArray::WIDTHS[n]+1 : 0;
+				apron(dst) = *voxel++;
+			});
+		}
+	}
+
+	/** Copy voxels of this chunk, and the faces of its neighbors into an apron. */
+	inline void FillApron(ApronArray& apron, const NeighborChunks& neighbors) const
+	{
+		FillApron(apron, CopyNeighborFaces(neighbors));
+	}
+
+	/** Faces of the chunk, in E_NEIGHBOR order, holding voxels edited since the last call. */
+	inline std::bitset<N_NEIGHBOR> TakeEditedFaces()
+	{
+		const std::bitset<N_NEIGHBOR> faces = _editedFaces;
+		_editedFaces.reset();
+		return faces;
+	}
+
+	/**
+	 * Make the bricks on given face stale, (E_NEIGHBOR order), so their
+	 * sections are rebuilt, when the neighbor behind it changed. It isn't
+	 * an edit of the face.
+	 */
+	inline void MarkFaceStale(size_t face)
+	{
+		ASSERT(face < N_NEIGHBOR, "No such face.");
+		++_generation;
+		const size_t n = face/2;
+		for(size_t brick = 0; brick < N_BRICKS; ++brick) {
+			typename VoxelArray::Coordinates lo, hi;
+			BrickBounds(brick, lo, hi);
+			if((face%2 == 0) ? hi[n] == VoxelArray::WIDTHS[n] : lo[n] == 0)
+				_brickGenerations[brick] = _generation;
+		}
+	}
+
+	/** Get list of neightbor voxel, read inside an apron. */
+	static inline ListNeighbor GetNeighborVoxels(const typename VoxelArray::Coordinates& coords, const ApronArray& apron)
+	{
+		const size_t center = ApronArray::IndexAt(Math::AddScalar<N>(coords, 1));
+		ListNeighbor neighbors;
+		for(size_t n = 0; n < N; ++n) {
+			neighbors[n*2+0] = apron[center + ApronArray::STRIDES[n]];
+			neighbors[n*2+1] = apron[center - ApronArray::STRIDES[n]];
+		}
+		return neighbors;
+	}
+
 	/** Get list of neightbor voxel (for any dimension). */
 	ListNeighbor GetNeighborVoxels(const typename VoxelArray::Coordinates& coords) const
 	{
@@ -153,7 +414,7 @@ public:
 
 	/** Get world pos of given voxel inside the chunk. */
 	template<size_t I = 0>
-	inline VectorNf<N> GetWorldPos(const typename VoxelArray::Coordinates& arrayCoords)
+	inline VectorNf<N> GetWorldPos(const typename VoxelArray::Coordinates& arrayCoords) const
 	{
 		if constexpr (I == N)
 			return VectorNf<N>();
@@ -196,57 +457,492 @@ public:
 	 * Type function used given as parameter to 'Procedural'.
 	 * Return new voxel id to assign in VoxelArray.
 	 */
-	using FunProcedural = VOXELSET_SIZE_T (*) (const Chunk& chunk, const VectorNf<N> worldPos, const typename VoxelArray::Coordinates& arrayCoords, const VOXELSET_SIZE_T previousVoxelID);
+	using FunProcedural = VOXELSET_SIZE_T (*) (const BasicChunk& chunk, const VectorNf<N> worldPos, const typename VoxelArray::Coordinates& arrayCoords, const VOXELSET_SIZE_T previousVoxelID);
 	
 	/** Fill chunk with the id in parameter. */
 	void Fill(VOXELSET_SIZE_T voxelID)
 	{
-		auto itBegin = _voxels.begin();
-		for(auto it = _voxels.begin(); it != _voxels.end(); ++it) {
-        	auto index = std::distance(itBegin, it);
-        	_voxels[index] = voxelID;
-    	}
+		_voxels.Fill(voxelID);
+		MarkAllDirty();
+	}
+
+	/** Index of the brick holding given voxel, bricks are in S order. */
+	static inline size_t BrickOf(const typename VoxelArray::Coordinates& coords)
+	{
+		size_t brick = 0;
+		for(size_t n = N; n-- > 0;) brick = brick*BRICK_COUNTS[n] + coords[n]/BRICK_WIDTHS[n];
+		return brick;
+	}
+
+	/** First voxel of given brick, and the voxel after its last one on each axis. */
+	static inline void BrickBounds(size_t brick, typename VoxelArray::Coordinates& lo, typename VoxelArray::Coordinates& hi)
+	{
+		for(size_t n = 0; n < N; ++n) {
+			lo[n] = (brick % BRICK_COUNTS[n])*BRICK_WIDTHS[n];
+			hi[n] = lo[n] + BRICK_WIDTHS[n];
+			brick /= BRICK_COUNTS[n];
+		}
+	}
+
+	/** Generation of the last edit of the chunk, increased by each edit. */
+	inline uint64 GetGeneration() const { return _generation; }
+
+	/**
+	 * Find again which bricks hold a voxel other than air, among the
+	 * bricks edited since the last update, so raycasts can skip the empty
+	 * ones. Return the number of bricks scanned.
+	 */
+	size_t UpdateBrickOccupancy()
+	{
+		if(_occupancyGeneration == _generation) return 0;
+		size_t scanned = 0;
+		for(size_t brick = 0; brick < N_BRICKS; ++brick) {
+			if(_occupancyGeneration != std::numeric_limits<uint64>::max() && _brickGenerations[brick] <= _occupancyGeneration) continue;
+			typename VoxelArray::Coordinates lo, hi;
+			BrickBounds(brick, lo, hi);
+			bool occupied = false;
+			ForEachIn(lo, hi, [this, &occupied](size_t index, const typename VoxelArray::Coordinates&) {
+				occupied = occupied || (VOXELSET_SIZE_T)_voxels[index] != 0;
+			});
+			_occupiedBricks[brick] = occupied;
+			++scanned;
+		}
+		_occupancyGeneration = _generation;
+		return scanned;
+	}
+
+	/** Say if the brick occupancy is up to date, so raycasts can use it. */
+	inline bool IsBrickOccupancyCurrent() const { return _occupancyGeneration == _generation; }
+
+	/** Generation of the last edit of given brick. */
+	inline uint64 GetBrickGeneration(size_t brick) const { return _brickGenerations[brick]; }
+
+	/** Read only access to the storage of the voxels. */
+	inline const VoxelArray& GetVoxels() const { return _voxels; }
+
+	/**
+	 * Run length encode the voxels, in the order of the storage,
+	 * to keep an idle chunk in memory, or to save it.
+	 */
+	inline RunLength<VOXELSET_SIZE_T> Compress() const
+	{
+		return RunLength<VOXELSET_SIZE_T>::Encode(_voxels);
+	}
+
+	/**
+	 * Replace the voxels of the chunk by the decoded ones. Return false,
+	 * leaving the chunk untouched, if the code isn't the size of the chunk.
+	 */
+	inline bool Decompress(const RunLength<VOXELSET_SIZE_T>& code)
+	{
+		if(!code.Decode(_voxels)) return false;
+		MarkAllDirty();
+		return true;
 	}
 
 	/** Execute a function for each voxel. */
 	template<typename F>
 	void Procedural(F fun)
 	{
-		auto itBegin = _voxels.begin();
-		//#pragma omp parallel for
-		for(auto it = _voxels.begin(); it != _voxels.end(); ++it) {
-        	auto index = std::distance(itBegin, it);
+		ProceduralRange(fun, 0, CAPACITY);
+		MarkAllDirty();
+	}
+
+	/**
+	 * Number of voxels in a slab, the unit of work of the parallel
+	 * Procedural. A slab is a slice of the chunk perpendicular to the
+	 * slowest axis, (or the same number of voxels along the curve for
+	 * Z and U ordering, so a set of bricks).
+	 */
+	static constexpr size_t SLAB_SIZE = CAPACITY / OpPack::Proj(N-1, DIMS...);
+
+	/**
+	 * Execute a function for each voxel, slabs are shared between the
+	 * threads of the pool.
+	 * Each voxel is written by exactly one task, so the result is the same
+	 * as the serial version, as long as 'fun' only depend on its parameters
+	 * and doesn't read other voxels of the chunk.
+	 * If the storage can't be written concurrently, slabs are generated in
+	 * parallel into a buffer, copied into the chunk afterward.
+	 */
+	template<typename F>
+	void Procedural(F fun, ThreadPool& pool)
+	{
+		constexpr size_t nSlabs = CAPACITY / SLAB_SIZE;
+		if constexpr (VoxelArray::CONCURRENT_WRITES) {
+			pool.ParallelFor(nSlabs, [this, &fun](size_t slab) {
+				ProceduralRange(fun, slab*SLAB_SIZE, (slab+1)*SLAB_SIZE);
+			});
+		} else {
+			std::vector<VOXELSET_SIZE_T> buffer(CAPACITY);
+			pool.ParallelFor(nSlabs, [this, &fun, &buffer](size_t slab) {
+				for(auto [index, arrayCoords] : VoxelArray::Coords(slab*SLAB_SIZE, (slab+1)*SLAB_SIZE)) {
+					const VOXELSET_SIZE_T previousVoxelID = _voxels[index];
+					buffer[index] = fun(*this, GetWorldPos(arrayCoords), arrayCoords, previousVoxelID);
+				}
+			});
+			for(size_t index = 0; index < CAPACITY; ++index) _voxels[index] = buffer[index];
+		}
+		MarkAllDirty();
+	}
 
-        	// Calculate array coords, and world position :
-        	typename VoxelArray::Coordinates arrayCoords;
-        	_voxels.CoordsFor(arrayCoords, index);
+	/** Execute a function for each voxel of the index range [first, last[. */
+	template<typename F>
+	void ProceduralRange(F& fun, size_t first, size_t last)
+	{
+		for(auto [index, arrayCoords] : VoxelArray::Coords(first, last)) {
+        	// Calculate world position :
 			VectorNf<N> worldPos = GetWorldPos(arrayCoords);
         	// Call client's function
+        	const VOXELSET_SIZE_T previousVoxelID = _voxels[index];
         	auto newVoxelID = fun(
         		*this,
         		worldPos,
         		arrayCoords,
-        		_voxels[index]
+        		previousVoxelID
         	);
         	//ASSERT(newVoxelID < VoxelSet.GetSize(), "Assigned procedural voxel is not in the set.");
         	_voxels[index] = newVoxelID;
     	}
 	}
 
+	/** Axis of the columns of the two stages Procedural, the up axis. */
+	static constexpr size_t COLUMN_AXIS = AXIS_Y;
+
+	/** Number of columns along COLUMN_AXIS. */
+	static constexpr size_t N_COLUMNS = CAPACITY / OpPack::Proj((COLUMN_AXIS < N) ? COLUMN_AXIS : 0, DIMS...);
+
+	/** Index of the column holding given voxel. */
+	static inline size_t ColumnIndex(const typename VoxelArray::Coordinates& coords)
+	{
+		size_t index = 0, stride = 1;
+		for(size_t n = 0; n < N; ++n) {
+			if(n == COLUMN_AXIS) continue;
+			index += coords[n]*stride;
+			stride *= VoxelArray::WIDTHS[n];
+		}
+		return index;
+	}
+
+	/** Coordinates of the lowest voxel of given column. */
+	static inline typename VoxelArray::Coordinates ColumnCoords(size_t column)
+	{
+		typename VoxelArray::Coordinates coords;
+		for(size_t n = 0; n < N; ++n) {
+			if(n == COLUMN_AXIS) coords[n] = 0;
+			else {
+				coords[n] = column % VoxelArray::WIDTHS[n];
+				column /= VoxelArray::WIDTHS[n];
+			}
+		}
+		return coords;
+	}
+
+	/**
+	 * Execute a function for each voxel, in two stages.
+	 * columnFun(chunk, worldPos, coords) is called once per column along
+	 * COLUMN_AXIS, (worldPos and coords are 0 on this axis), and can
+	 * return anything, like a ground level from a 2D noise.
+	 * voxelFun(chunk, worldPos, coords, previousVoxelID, column) is then
+	 * called for each voxel with the result of its column, and return the
+	 * new voxel id.
+	 */
+	template<typename FC, typename FV>
+	void Procedural(FC columnFun, FV voxelFun)
+	{
+		auto columns = GenColumns(columnFun, nullptr);
+		Procedural(ColumnStage(voxelFun, columns));
+	}
+
+	/** Two stages Procedural, both stages are shared between the threads of the pool. */
+	template<typename FC, typename FV>
+	void Procedural(FC columnFun, FV voxelFun, ThreadPool& pool)
+	{
+		auto columns = GenColumns(columnFun, &pool);
+		Procedural(ColumnStage(voxelFun, columns), pool);
+	}
+
+private:
+	/** Sample nodes of index range [first, last[ of a coarse field. */
+	template<size_t STEP, typename F>
+	void SampleCoarseRange(CoarseArray<STEP>& coarse, F& fun, size_t first, size_t last) const
+	{
+		static_assert(!OpPack::HasValue(true, (DIMS % STEP != 0)...), "Width of the chunk must be a multiple of STEP.");
+		for(auto [index, node] : CoarseArray<STEP>::Coords(first, last))
+			coarse[index] = fun(GetWorldPos(Math::MulScalar<N>(node, STEP)));
+	}
+
+	/** Call columnFun for each column, in parallel if there is a pool. */
+	template<typename FC>
+	auto GenColumns(FC& columnFun, ThreadPool* pool) const
+	{
+		static_assert(COLUMN_AXIS < N, "Chunk has no up axis for columns.");
+		using Column = std::decay_t<decltype(columnFun(*this, VectorNf<N>(), typename VoxelArray::Coordinates()))>;
+		std::vector<Column> columns(N_COLUMNS);
+
+		constexpr size_t BLOCK = OpPack::Proj(0, DIMS...);
+		auto genBlock = [this, &columnFun, &columns](size_t block) {
+			for(size_t column = block*BLOCK; column < std::min((block+1)*BLOCK, N_COLUMNS); ++column) {
+				auto coords = ColumnCoords(column);
+				VectorNf<N> worldPos = GetWorldPos(coords);
+				worldPos[COLUMN_AXIS] = 0;
+				columns[column] = columnFun(*this, worldPos, coords);
+			}
+		};
+		const size_t nBlocks = (N_COLUMNS + BLOCK-1) / BLOCK;
+		if(pool) pool->ParallelFor(nBlocks, genBlock);
+		else for(size_t block = 0; block < nBlocks; ++block) genBlock(block);
+		return columns;
+	}
+
+	/** Per voxel stage of the two stages Procedural, reading the column of each voxel. */
+	template<typename FV, typename Column>
+	static inline auto ColumnStage(FV& voxelFun, const std::vector<Column>& columns)
+	{
+		return [&voxelFun, &columns](const BasicChunk& chunk, const VectorNf<N>& worldPos, const typename VoxelArray::Coordinates& coords, VOXELSET_SIZE_T previousVoxelID) {
+			return voxelFun(chunk, worldPos, coords, previousVoxelID, columns[ColumnIndex(coords)]);
+		};
+	}
+
+public:
+	/** Sample fun(worldPos) at each node of a coarse field. */
+	template<size_t STEP, typename F>
+	void SampleCoarse(CoarseArray<STEP>& coarse, F fun) const
+	{
+		SampleCoarseRange<STEP>(coarse, fun, 0, CoarseArray<STEP>::SIZE);
+	}
+
+	/** Sample a coarse field, nodes are shared between the threads of the pool. */
+	template<size_t STEP, typename F>
+	void SampleCoarse(CoarseArray<STEP>& coarse, F fun, ThreadPool& pool) const
+	{
+		constexpr size_t BLOCK = OpPack::Proj(0, (DIMS/STEP+1)...);
+		constexpr size_t nBlocks = CoarseArray<STEP>::SIZE / BLOCK;
+		pool.ParallelFor(nBlocks, [this, &coarse, &fun](size_t block) {
+			SampleCoarseRange<STEP>(coarse, fun, block*BLOCK, (block+1)*BLOCK);
+		});
+	}
+
+	/** N-linear interpolation of a coarse field at given voxel. */
+	template<size_t STEP>
+	static inline float InterpolateCoarse(const CoarseArray<STEP>& coarse, const typename VoxelArray::Coordinates& coords)
+	{
+		using CoarseCoords = typename CoarseArray<STEP>::Coordinates;
+		CoarseCoords cell;
+		std::array<float, N> f;
+		for(size_t n = 0; n < N; ++n) {
+			cell[n] = coords[n] / STEP;
+			f[n] = (coords[n] % STEP) * (1.0f/STEP);
+		}
+
+		std::array<float, Math::pow<2, N>()> values;
+		auto it = values.begin();
+		std::array<size_t, N> forloop_limits;
+		std::fill_n(forloop_limits.begin(), N, 2);
+		Misc::NestedForLoops<N>([&](const CoarseCoords& corner) {
+			*it = coarse(Math::Add<N>(cell, corner));
+			++it;
+			NFL_LAST_CALL;
+		}, forloop_limits);
+		return Math::nlerp<N>(values, f);
+	}
+
+	/**
+	 * Generate a mesh composed of cubes from chunk.
+	 * Voxels outside the chunk are considered as air.
+	 */
+	TriangleMesh CubicMesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet) const
+	{
+		MeshBuilder mesh;
+		CubicMeshBox(voxelSet, NeighborsOrAir(), typename VoxelArray::Coordinates{}, VoxelArray::WIDTHS, mesh);
+		return mesh.ToTriangleMesh();
+	}
+
 	/**
 	 * Generate a mesh composed of cubes from chunk.
+	 * Faces on the border of the chunk are culled against neighbors chunks.
+	 */
+	TriangleMesh CubicMesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, const NeighborChunks& neighbors) const
+	{
+		std::unique_ptr<ApronArray> apron(new ApronArray());
+		FillApron(*apron, neighbors);
+		MeshBuilder mesh;
+		CubicMeshBox(voxelSet, NeighborsIn(*apron), typename VoxelArray::Coordinates{}, VoxelArray::WIDTHS, mesh);
+		return mesh.ToTriangleMesh();
+	}
+
+	/**
+	 * Generate a mesh from chunk, where coplanar faces of the same voxel
+	 * are merged into maximal rectangles.
+	 * Voxels outside the chunk are considered as air.
+	 */
+	TriangleMesh GreedyMesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet) const
+	{
+		MeshBuilder mesh;
+		GreedyMeshBox(voxelSet, NeighborOrAir(), typename VoxelArray::Coordinates{}, VoxelArray::WIDTHS, mesh);
+		return mesh.ToTriangleMesh();
+	}
+
+	/**
+	 * Generate a mesh from chunk, where coplanar faces of the same voxel
+	 * are merged into maximal rectangles.
+	 * Faces on the border of the chunk are culled against neighbors chunks.
+	 */
+	TriangleMesh GreedyMesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, const NeighborChunks& neighbors) const
+	{
+		std::unique_ptr<ApronArray> apron(new ApronArray());
+		FillApron(*apron, neighbors);
+		MeshBuilder mesh;
+		GreedyMeshBox(voxelSet, NeighborIn(*apron), typename VoxelArray::Coordinates{}, VoxelArray::WIDTHS, mesh);
+		return mesh.ToTriangleMesh();
+	}
+
+	/**
+	 * Rebuild the sections of a mesh, one per brick, whose voxels were
+	 * edited since the section was built, the others are kept as they are.
+	 * Greedy sections merge faces inside their brick only, packed sections
+	 * can only be greedy.
+	 * Voxels outside the chunk are considered as air.
+	 * Return the number of sections rebuilt.
+	 */
+	template<typename BUILDER>
+	size_t Remesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, BasicSectionedMesh<BUILDER>& mesh, bool greedy = true) const
+	{
+		return RemeshWith(voxelSet, mesh, greedy, NeighborsOrAir(), NeighborOrAir());
+	}
+
+	/**
+	 * Rebuild the sections of a mesh whose voxels were edited, faces on
+	 * the border of the chunk are culled against neighbors chunks.
+	 * Edits of the neighbors don't make sections stale, MarkFaceStale must
+	 * be called on the faces they touch.
+	 */
+	template<typename BUILDER>
+	size_t Remesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, BasicSectionedMesh<BUILDER>& mesh, const NeighborChunks& neighbors, bool greedy = true) const
+	{
+		return Remesh(voxelSet, mesh, CopyNeighborFaces(neighbors), greedy);
+	}
+
+	/** Same, with copies of the layers of the neighbors, taken when they could be read. */
+	template<typename BUILDER>
+	size_t Remesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, BasicSectionedMesh<BUILDER>& mesh, const NeighborFaces& faces, bool greedy = true) const
+	{
+		std::unique_ptr<ApronArray> apron(new ApronArray());
+		FillApron(*apron, faces);
+		return RemeshWith(voxelSet, mesh, greedy, NeighborsIn(*apron), NeighborIn(*apron));
+	}
+
+private:
+	/** ListNeighbor of a voxel, voxels outside the chunk are air. */
+	inline auto NeighborsOrAir() const
+	{
+		return [this](const typename VoxelArray::Coordinates& coords) {
+			return GetNeighborVoxels(coords);
+		};
+	}
+
+	/** ListNeighbor of a voxel, read in the apron. */
+	static inline auto NeighborsIn(const ApronArray& apron)
+	{
+		return [&apron](const typename VoxelArray::Coordinates& coords) {
+			return GetNeighborVoxels(coords, apron);
+		};
+	}
+
+	/** Voxel next to another along an axis, voxels outside the chunk are air. */
+	inline auto NeighborOrAir() const
+	{
+		return [this](typename VoxelArray::Coordinates coords, size_t axis, int dir) {
+			constexpr VOXELSET_SIZE_T defaultVoxelID = 0;
+			if(dir > 0 && coords[axis]+1 >= VoxelArray::WIDTHS[axis]) return defaultVoxelID;
+			if(dir < 0 && coords[axis] == 0) return defaultVoxelID;
+			coords[axis] += dir;
+			return (VOXELSET_SIZE_T)_voxels(coords);
+		};
+	}
+
+	/** Voxel next to another along an axis, read in the apron. */
+	static inline auto NeighborIn(const ApronArray& apron)
+	{
+		return [&apron](const typename VoxelArray::Coordinates& coords, size_t axis, int dir) {
+			const size_t center = ApronArray::IndexAt(Math::AddScalar<N>(coords, 1));
+			return apron[center + dir*ApronArray::STRIDES[axis]];
+		};
+	}
+
+	/** Rebuild stale sections, with the neighbors given to the cubic or the greedy mesher. */
+	template<typename BUILDER, typename FC, typename FG>
+	size_t RemeshWith(const VoxelSet<VOXELSET_SIZE_T>& voxelSet, BasicSectionedMesh<BUILDER>& mesh, bool greedy, FC getNeighbors, FG neighborAt) const
+	{
+		static_assert(N == 3, "A cubic mesh is only for a 3D space.");
+		constexpr bool PACKED = std::is_same<BUILDER, PackedMeshBuilder>::value;
+		static_assert(!PACKED || std::max({DIMS...}) <= PackedMeshBuilder::COORD_MASK, "Chunk is too wide for packed vertices.");
+		static_assert(!PACKED || sizeof(VOXELSET_SIZE_T) == 1, "Packed vertices store 8 bits voxel IDs.");
+		ASSERT(greedy || !PACKED, "Packed sections can only be greedy.");
+		if(mesh.GetSectionCount() != N_BRICKS) mesh.Resize(N_BRICKS);
+
+		size_t rebuilt = 0;
+		for(size_t brick = 0; brick < N_BRICKS; ++brick) {
+			if(!mesh.IsStale(brick, _brickGenerations[brick])) continue;
+			typename VoxelArray::Coordinates lo, hi;
+			BrickBounds(brick, lo, hi);
+			BUILDER& section = mesh.BeginSection(brick);
+			if constexpr(PACKED) {
+				section.SetFrame(GetOrigin(), _voxelSize);
+				GreedyMeshBox(voxelSet, neighborAt, lo, hi, section);
+			} else {
+				if(greedy) GreedyMeshBox(voxelSet, neighborAt, lo, hi, section);
+				else CubicMeshBox(voxelSet, getNeighbors, lo, hi, section);
+			}
+			mesh.EndSection(brick, _generation);
+			++rebuilt;
+		}
+		return rebuilt;
+	}
+
+	/**
+	 * Call fun(index, coords) for each voxel of the box [lo, hi[,
+	 * in the order of the storage for the whole chunk.
+	 */
+	template<typename F>
+	static inline void ForEachIn(const typename VoxelArray::Coordinates& lo, const typename VoxelArray::Coordinates& hi, F fun)
+	{
+		if(lo == typename VoxelArray::Coordinates{} && hi == VoxelArray::WIDTHS) {
+			for(auto [index, coords] : VoxelArray::Coords()) fun(index, coords);
+			return;
+		}
+		typename VoxelArray::Coordinates sizes;
+		for(size_t n = 0; n < N; ++n) sizes[n] = hi[n] - lo[n];
+		Misc::NestedForLoops<N>([&lo, &fun](const typename VoxelArray::Coordinates& local) {
+			const typename VoxelArray::Coordinates coords = Math::Add<N>(lo, local);
+			fun(VoxelArray::IndexAt(coords), coords);
+			NFL_LAST_CALL;
+		}, sizes);
+	}
+
+	/**
+	 * Add to a mesh the cubes of the voxels of the box [lo, hi[.
+	 * getNeighbors(coords) give the ListNeighbor of a voxel.
 	 */
-	TriangleMesh CubicMesh(const VoxelSet<VOXELSET_SIZE_T>& voxelSet)
+	template<typename F>
+	void CubicMeshBox(
+		const VoxelSet<VOXELSET_SIZE_T>& voxelSet, F getNeighbors,
+		const typename VoxelArray::Coordinates& lo, const typename VoxelArray::Coordinates& hi,
+		MeshBuilder& mesh) const
 	{
 		static_assert(N == 3, "A cubic mesh is only for a 3D space.");
 
-		TriangleMesh mesh;
-	    mesh.addAttrib("in_color", Ra::Core::Vector4Array{});
+		// Count faces first, so buffers are allocated only once.
+		size_t nFaces = 0;
+		ForEachIn(lo, hi, [&](size_t index, const typename VoxelArray::Coordinates& coords) {
+			if(voxelSet.IsOpaque(_voxels[index]))
+				nFaces += voxelSet.Get(_voxels[index]).CountVisibleFaces(getNeighbors(coords));
+		});
+		mesh.Reserve(nFaces);
 
-		auto itBegin = _voxels.begin();
-		for(auto it = _voxels.begin(); it != _voxels.end(); ++it) {
-			auto index = std::distance(itBegin, it);
-        	auto coords = VoxelArray::CoordsFor(index);
+		ForEachIn(lo, hi, [&](size_t index, const typename VoxelArray::Coordinates& coords) {
+			// Skip air without touching the voxel definition.
+			if(!voxelSet.IsOpaque(_voxels[index])) return;
 
         	// Calculate offset voxel, relative to this chunk.
         	Vector3f offset(
@@ -259,15 +955,127 @@ public:
         	auto voxelID = _voxels[index];
         	const Voxel<VOXELSET_SIZE_T>& voxel = voxelSet.Get(voxelID);
 			if(voxel.visible) {
-				ListNeighbor neighbors = GetNeighborVoxels(coords);
+				ListNeighbor neighbors = getNeighbors(coords);
 				voxel.AppendCube(neighbors, offset, mesh, _halfVoxelSize);
 			}
-    	}
-    	mesh.checkConsistency();
+		});
+	}
+
+	/**
+	 * Greedy meshing of the box [lo, hi[, faces are merged inside the box.
+	 * neighborAt(coords, axis, dir) give the voxel next to coords along
+	 * axis, in direction dir (1 or -1).
+	 * For each axis, each direction, and each slice of the box, visible
+	 * faces are written in a 2D mask of voxel IDs, then the mask is
+	 * swept and each face grows along U then V as long as it meets the same
+	 * voxel ID, (so the same color).
+	 */
+	template<typename F, typename BUILDER>
+	void GreedyMeshBox(
+		const VoxelSet<VOXELSET_SIZE_T>& voxelSet, F neighborAt,
+		const typename VoxelArray::Coordinates& lo, const typename VoxelArray::Coordinates& hi,
+		BUILDER& mesh) const
+	{
+		static_assert(N == 3, "A cubic mesh is only for a 3D space.");
+		using Coordinates = typename VoxelArray::Coordinates;
+		constexpr size_t NO_FACE = std::numeric_limits<size_t>::max();
+
+		const size_t volume = (hi[0]-lo[0])*(hi[1]-lo[1])*(hi[2]-lo[2]);
+		std::vector<size_t> mask(volume / std::min({hi[0]-lo[0], hi[1]-lo[1], hi[2]-lo[2]}));
+
+		for(size_t d = 0; d < N; ++d) {
+			// (d, u, v) is a direct basis.
+			const size_t u = (d+1)%N, v = (d+2)%N;
+			const size_t widthU = hi[u] - lo[u];
+			const size_t widthV = hi[v] - lo[v];
+
+			for(int dir = 1; dir >= -1; dir -= 2) {
+				for(size_t layer = lo[d]; layer < hi[d]; ++layer) {
+					// Build mask of visible faces for this slice.
+					Coordinates c;
+					c[d] = layer;
+					for(c[v] = lo[v]; c[v] < hi[v]; ++c[v]) {
+						for(c[u] = lo[u]; c[u] < hi[u]; ++c[u]) {
+							size_t& cell = mask[(c[v]-lo[v])*widthU + c[u]-lo[u]];
+							cell = NO_FACE;
+							const VOXELSET_SIZE_T voxelID = _voxels(c);
+							if(!voxelSet.IsOpaque(voxelID)) continue;
+
+							const VOXELSET_SIZE_T neighborID = neighborAt(c, d, dir);
+							if(voxelSet.IsFaceVisible(voxelID, neighborID)) cell = voxelID;
+						}
+					}
+
+					// Plane of the faces, on the lattice of voxel corners.
+					const uint32 planeD = layer + (dir > 0 ? 1 : 0);
+
+					// Sweep mask and merge faces.
+					for(size_t j = 0; j < widthV; ++j) {
+						for(size_t i = 0; i < widthU;) {
+							const size_t voxelID = mask[j*widthU + i];
+							if(voxelID == NO_FACE) { ++i; continue; }
+
+							// Grow along U.
+							size_t w = 1;
+							while(i+w < widthU && mask[j*widthU + i+w] == voxelID) ++w;
+
+							// Grow along V, while the whole row match.
+							size_t h = 1;
+							for(; j+h < widthV; ++h) {
+								bool match = true;
+								for(size_t k = 0; k < w && match; ++k)
+									match = mask[(j+h)*widthU + i+k] == voxelID;
+								if(!match) break;
+							}
+
+							// Consume merged faces.
+							for(size_t l = 0; l < h; ++l)
+								for(size_t k = 0; k < w; ++k)
+									mask[(j+l)*widthU + i+k] = NO_FACE;
+
+							// Emit quad.
+							PackedMeshBuilder::Lattice p0, p1, p2, p3;
+							p0[d] = p1[d] = p2[d] = p3[d] = planeD;
+							p0[u] = lo[u]+i;   p0[v] = lo[v]+j;
+							p1[u] = lo[u]+i+w; p1[v] = lo[v]+j;
+							p2[u] = lo[u]+i+w; p2[v] = lo[v]+j+h;
+							p3[u] = lo[u]+i;   p3[v] = lo[v]+j+h;
+
+							// Counter clockwise when seen from the normal.
+							if(dir > 0) EmitQuad(voxelSet, {p0, p1, p2, p3}, d, dir, voxelID, mesh);
+							else EmitQuad(voxelSet, {p0, p3, p2, p1}, d, dir, voxelID, mesh);
+
+							i += w;
+						}
+					}
+				}
+			}
+		}
+	}
 
-    	return mesh;
+	/** Add a quad given by its corners on the lattice, in world space. */
+	inline void EmitQuad(
+		const VoxelSet<VOXELSET_SIZE_T>& voxelSet, const std::array<PackedMeshBuilder::Lattice, 4>& corners,
+		size_t axis, int dir, size_t voxelID, MeshBuilder& mesh) const
+	{
+		Vector3f p[4];
+		for(size_t c = 0; c < 4; ++c)
+			for(size_t n = 0; n < N; ++n)
+				p[c][n] = corners[c][n]*_voxelSize - _halfChunkWorldSize + _worldPos[n];
+		Vector3f normal(0, 0, 0);
+		normal[axis] = dir;
+		mesh.AddQuad(p[0], p[1], p[2], p[3], normal, voxelSet.Get(voxelID).color);
 	}
 
+	/** Add a quad given by its corners on the lattice, packed. */
+	static inline void EmitQuad(
+		const VoxelSet<VOXELSET_SIZE_T>&, const std::array<PackedMeshBuilder::Lattice, 4>& corners,
+		size_t axis, int dir, size_t voxelID, PackedMeshBuilder& mesh)
+	{
+		mesh.AddQuad(corners[0], corners[1], corners[2], corners[3], 2*axis + (dir < 0 ? 1 : 0), voxelID);
+	}
+
+public:
 	/**
 	 * Get width of the array on a given axes at compile time.
 	 */
@@ -299,6 +1107,7 @@ public:
 	inline void SetVoxel(const typename VoxelArray::Coordinates coords, const VOXELSET_SIZE_T voxelID)
 	{
 		_voxels(coords) = voxelID;
+		MarkDirty(coords);
 	}
 
 
@@ -308,38 +1117,202 @@ public:
 		return _voxels(coords);
 	}
 
-	/** Draw sphere at world position. */
-	/*void DrawSphereAt(const VectorNf& worldPos, const float radius, const VOXELSET_SIZE_T voxelID)
+	/**
+	 * Set the voxels whose center is inside a sphere, in world space.
+	 * Return the number of voxels changed.
+	 */
+	size_t DrawSphere(const VectorNf<N>& worldCenter, const float radius, const VOXELSET_SIZE_T voxelID)
 	{
-		std::array<size_t, N> sizes; for(size_t i = 0; i < N; ++i) sizes[i] = radius;
-		NestedForLoops([this] (const std::array<size_t, N>& coords) {
-			this->SetVoxelAt(worldPos, voxelID)
-		},sizes);
-	}*/
+		ASSERT(radius >= 0.0f, "Sphere's radius cannot be negative.");
+		const VectorNf<N> extent = VectorNf<N>::Constant(radius);
+		return DrawIn(worldCenter - extent, worldCenter + extent, voxelID, [&worldCenter, radius](const VectorNf<N>& center) {
+			return (center - worldCenter).squaredNorm() <= radius*radius;
+		});
+	}
 
-	/*void DrawCapsule(const VectorNf& worldA, const float radiusA, const VectorNf& worldB, const float radiusB, const VOXELSET_SIZE_T voxelID)
+	/**
+	 * Set the voxels whose center is inside a box, in world space.
+	 * Return the number of voxels changed.
+	 */
+	size_t DrawBox(const VectorNf<N>& worldMin, const VectorNf<N>& worldMax, const VOXELSET_SIZE_T voxelID)
 	{
+		return DrawIn(worldMin, worldMax, voxelID, [](const VectorNf<N>&) { return true; });
+	}
 
-	}*/
+	/**
+	 * Set the voxels whose center is inside a capsule from A to B, in world
+	 * space. Its radius goes linearly from radiusA to radiusB along the
+	 * segment, measured from the nearest point of the segment.
+	 * Return the number of voxels changed.
+	 */
+	size_t DrawCapsule(const VectorNf<N>& worldA, const float radiusA, const VectorNf<N>& worldB, const float radiusB, const VOXELSET_SIZE_T voxelID)
+	{
+		ASSERT(radiusA >= 0.0f && radiusB >= 0.0f, "Capsule's radius cannot be negative.");
+		const VectorNf<N> extentA = VectorNf<N>::Constant(radiusA);
+		const VectorNf<N> extentB = VectorNf<N>::Constant(radiusB);
+		const VectorNf<N> ab = worldB - worldA;
+		const float invLength2 = (ab.squaredNorm() > 0.0f) ? 1.0f/ab.squaredNorm() : 0.0f;
+		return DrawIn(
+			(worldA - extentA).cwiseMin(worldB - extentB), (worldA + extentA).cwiseMax(worldB + extentB), voxelID,
+			[&worldA, &ab, invLength2, radiusA, radiusB](const VectorNf<N>& center) {
+				const float t = std::clamp((center - worldA).dot(ab)*invLength2, 0.0f, 1.0f);
+				const float radius = radiusA + (radiusB - radiusA)*t;
+				return (center - worldA - ab*t).squaredNorm() <= radius*radius;
+			}
+		);
+	}
 
-	/** Draw line from A to B. */
-	void DrawLine(const VectorNf<N>& worldA, const VectorNf<N>& worldB, const float radius, const VOXELSET_SIZE_T voxelID)
+	/**
+	 * Draw line from A to B, in world space. Thin lines are widened to
+	 * the smallest radius keeping their voxels connected.
+	 * Return the number of voxels changed.
+	 */
+	size_t DrawLine(const VectorNf<N>& worldA, const VectorNf<N>& worldB, const float radius, const VOXELSET_SIZE_T voxelID)
 	{
 		ASSERT(radius >= 0.0f, "Line's radius cannot be negative.");
-		for(float k = 0; k <= 1.0f; k += 0.01f) {
-			SetVoxelAt(Math::lerp(worldA, worldB, k), voxelID);
+		const float thickness = std::max(radius, _halfVoxelSize*std::sqrt((float)(N-1)));
+		return DrawCapsule(worldA, thickness, worldB, thickness, voxelID);
+	}
+
+	/** Opaque voxel hit by a ray. */
+	struct RayHit {
+		typename VoxelArray::Coordinates coords;
+		VOXELSET_SIZE_T voxelID;
+
+		/** Face the ray entered by (E_NEIGHBOR), GridRay<N>::NO_FACE if the ray started inside. */
+		size_t face;
+
+		/** Distance along the ray, in lengths of its direction. */
+		float distance;
+	};
+
+	/**
+	 * Find the first opaque voxel pierced by a ray starting at origin,
+	 * along dir, before maxDistance (in lengths of dir), walking voxels
+	 * in order with a DDA. With skipEmptyBricks, the walk is done on
+	 * bricks first, and only enter bricks holding voxels, if the brick
+	 * occupancy is up to date (see UpdateBrickOccupancy), otherwise every
+	 * voxel is walked. Return false if no voxel is hit.
+	 */
+	bool Raycast(const VectorNf<N>& origin, const VectorNf<N>& dir, float maxDistance,
+		const VoxelSet<VOXELSET_SIZE_T>& voxelSet, RayHit& hit, bool skipEmptyBricks = false) const
+	{
+		const VectorNf<N> corner = GetOrigin();
+		float tEnter, tExit;
+		size_t axis;
+		if(!ClipRay<N>(origin, dir, corner, corner + VectorNf<N>::Constant(_chunkWorldSize), tEnter, tExit, axis)) return false;
+		tExit = std::min(tExit, maxDistance);
+		if(tEnter > tExit) return false;
+
+		typename GridRay<N>::Cell lo{}, hi;
+		if(!skipEmptyBricks || !IsBrickOccupancyCurrent()) {
+			for(size_t n = 0; n < N; ++n) hi[n] = VoxelArray::WIDTHS[n];
+			return RaycastIn(origin, dir, tEnter, tExit, axis, lo, hi, voxelSet, hit);
+		}
+
+		VectorNf<N> brickSize;
+		for(size_t n = 0; n < N; ++n) {
+			hi[n] = BRICK_COUNTS[n];
+			brickSize[n] = BRICK_WIDTHS[n]*_voxelSize;
+		}
+		for(GridRay<N> bricks(origin, dir, corner, brickSize, tEnter, axis, lo, hi);
+			bricks.GetDistance() <= tExit && bricks.IsIn(lo, hi); bricks.Next()) {
+			typename VoxelArray::Coordinates first;
+			for(size_t n = 0; n < N; ++n) first[n] = bricks.GetCell()[n]*BRICK_WIDTHS[n];
+			if(!_occupiedBricks[BrickOf(first)]) continue;
+
+			typename GridRay<N>::Cell voxelLo, voxelHi;
+			for(size_t n = 0; n < N; ++n) {
+				voxelLo[n] = first[n];
+				voxelHi[n] = first[n] + BRICK_WIDTHS[n];
+			}
+			const float tEnd = std::min(bricks.GetExitDistance(), tExit);
+			if(RaycastIn(origin, dir, bricks.GetDistance(), tEnd, bricks.GetAxis(), voxelLo, voxelHi, voxelSet, hit)) return true;
 		}
-		/*auto dist = Math::enclidian_dist(worldA, worldB);
-		auto vecAB = VecAToB(worldA, worldB)
-		for(float i = 0; i < dist; i += _voxelSize) {
+		return false;
+	}
 
-		}*/
+private:
+	/** Walk the voxels of the box [lo, hi[ pierced by a ray between tStart and tEnd, until an opaque one. */
+	bool RaycastIn(const VectorNf<N>& origin, const VectorNf<N>& dir, float tStart, float tEnd, size_t axis,
+		const typename GridRay<N>::Cell& lo, const typename GridRay<N>::Cell& hi,
+		const VoxelSet<VOXELSET_SIZE_T>& voxelSet, RayHit& hit) const
+	{
+		for(GridRay<N> ray(origin, dir, GetOrigin(), VectorNf<N>::Constant(_voxelSize), tStart, axis, lo, hi);
+			ray.GetDistance() <= tEnd && ray.IsIn(lo, hi); ray.Next()) {
+			typename VoxelArray::Coordinates coords;
+			for(size_t n = 0; n < N; ++n) coords[n] = ray.GetCell()[n];
+			const VOXELSET_SIZE_T voxelID = _voxels(coords);
+			if(!voxelSet.IsOpaque(voxelID)) continue;
+			hit.coords = coords;
+			hit.voxelID = voxelID;
+			hit.face = ray.GetFace();
+			hit.distance = ray.GetDistance();
+			return true;
+		}
+		return false;
+	}
+
+private:
+	/**
+	 * Range [lo, hi[ of the voxels whose center is in the world box
+	 * [worldMin, worldMax]. Return false if there is none.
+	 */
+	inline bool VoxelRangeIn(const VectorNf<N>& worldMin, const VectorNf<N>& worldMax,
+		typename VoxelArray::Coordinates& lo, typename VoxelArray::Coordinates& hi) const
+	{
+		for(size_t n = 0; n < N; ++n) {
+			const float first = std::ceil((worldMin[n] - _worldPos[n] + _halfChunkWorldSize)/_voxelSize - 0.5f);
+			const float last = std::floor((worldMax[n] - _worldPos[n] + _halfChunkWorldSize)/_voxelSize - 0.5f);
+			if(first > last || last < 0.0f || first >= (float)VoxelArray::WIDTHS[n]) return false;
+			lo[n] = (size_t)std::max(first, 0.0f);
+			hi[n] = std::min((size_t)last + 1, VoxelArray::WIDTHS[n]);
+		}
+		return true;
+	}
+
+	/**
+	 * Set the voxels of the world box [worldMin, worldMax] whose center
+	 * pass inside(center). The range of voxels is computed once, and the
+	 * edit is recorded once, for the bricks it touched.
+	 * Return the number of voxels changed.
+	 */
+	template<typename F>
+	size_t DrawIn(const VectorNf<N>& worldMin, const VectorNf<N>& worldMax, const VOXELSET_SIZE_T voxelID, F inside)
+	{
+		typename VoxelArray::Coordinates lo, hi;
+		if(!VoxelRangeIn(worldMin, worldMax, lo, hi)) return 0;
+
+		const VectorNf<N> origin = GetOrigin() + VectorNf<N>::Constant(_halfVoxelSize);
+		typename VoxelArray::Coordinates changedLo = hi, changedHi = lo;
+		size_t changed = 0;
+		ForEachIn(lo, hi, [&](size_t index, const typename VoxelArray::Coordinates& coords) {
+			VectorNf<N> center;
+			for(size_t n = 0; n < N; ++n) center[n] = origin[n] + coords[n]*_voxelSize;
+			if(!inside(center) || (VOXELSET_SIZE_T)_voxels[index] == voxelID) return;
+			_voxels[index] = voxelID;
+			for(size_t n = 0; n < N; ++n) {
+				changedLo[n] = std::min(changedLo[n], coords[n]);
+				changedHi[n] = std::max(changedHi[n], coords[n]+1);
+			}
+			++changed;
+		});
+		if(changed > 0) MarkDirty(changedLo, changedHi);
+		return changed;
 	}
 
 };
 
 #include "Chunk.inl"
 
+/** Chunk storing its voxels plainly inside a NArray. */
+template<IndexingMode::Enum INDEXING, typename VOXELSET_SIZE_T, size_t... DIMS>
+using Chunk = BasicChunk<NArray, INDEXING, VOXELSET_SIZE_T, DIMS...>;
+
+/** Chunk storing its voxels inside a PaletteArray, for mostly uniform chunks. */
+template<IndexingMode::Enum INDEXING, typename VOXELSET_SIZE_T, size_t... DIMS>
+using PaletteChunk = BasicChunk<PaletteArray, INDEXING, VOXELSET_SIZE_T, DIMS...>;
+
 template<typename VOXELSET_SIZE_T = uint8>
 using Chunk1 = Chunk<IndexingMode::S_ORDERING, VOXELSET_SIZE_T, 1, 1, 1>;
 
@@ -376,6 +1349,18 @@ using Chunk1024 = Chunk<IndexingMode::S_ORDERING, VOXELSET_SIZE_T, 1024, 1024, 1
 template<typename VOXELSET_SIZE_T = uint8>
 using Chunk2048 = Chunk<IndexingMode::S_ORDERING, VOXELSET_SIZE_T, 2048, 2048, 2048>;
 
+/** Cubic chunk stored along the Z-order curve, SIZE must be a power of two. */
+template<size_t SIZE, typename VOXELSET_SIZE_T = uint8>
+using ZChunk = Chunk<IndexingMode::Z_ORDERING, VOXELSET_SIZE_T, SIZE, SIZE, SIZE>;
+
+/** Cubic chunk stored along the Hilbert curve, SIZE must be a power of two. */
+template<size_t SIZE, typename VOXELSET_SIZE_T = uint8>
+using UChunk = Chunk<IndexingMode::U_ORDERING, VOXELSET_SIZE_T, SIZE, SIZE, SIZE>;
+
+/** Cubic chunk compressed with a palette. */
+template<size_t SIZE, typename VOXELSET_SIZE_T = uint8>
+using SparseChunk = PaletteChunk<IndexingMode::S_ORDERING, VOXELSET_SIZE_T, SIZE, SIZE, SIZE>;
+
 
 /** Unit test for Chunk class. */
 void unitests_chunk();
@@ -0,0 +1,93 @@
+#include "ChunkAllocator.hpp"
+#include "Chunk.hpp"
+
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace HyperV {
+
+size_t Pages::Size()
+{
+#if defined(__linux__)
+	static const size_t size = (size_t)sysconf(_SC_PAGESIZE);
+	return size;
+#else
+	return 4096;
+#endif
+}
+
+void* Pages::Map(size_t size, bool& huge)
+{
+#if defined(__linux__)
+	const int prot = PROT_READ | PROT_WRITE;
+	const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	if(huge && size%HUGE_SIZE == 0) {
+		void* pages = mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0);
+		if(pages != MAP_FAILED) return pages;
+	}
+	void* pages = mmap(nullptr, size, prot, flags, -1, 0);
+	if(pages == MAP_FAILED) return nullptr;
+	// Ask for transparent huge pages instead, when there is no huge pages reserved.
+	if(huge) madvise(pages, size, MADV_HUGEPAGE);
+	huge = false;
+	return pages;
+#else
+	huge = false;
+	return std::aligned_alloc(Size(), size);
+#endif
+}
+
+void Pages::Unmap(void* pages, size_t size)
+{
+#if defined(__linux__)
+	munmap(pages, size);
+#else
+	std::free(pages);
+#endif
+}
+
+} // namespace HyperV
+
+void HyperV::unitests_chunk_allocator()
+{
+	using TestChunk = Chunk32<uint8>;
+	ChunkAllocator<TestChunk> allocator;
+	ASSERT_ALWAYS(allocator.GetBlockSize()%Pages::Size() == 0, "Big chunks must take whole pages.");
+	ASSERT_ALWAYS(allocator.GetCapacity() == 0 && allocator.GetReservedBytes() == 0, "Nothing must be mapped before the first chunk.");
+
+	std::vector<ChunkPtr<TestChunk>> chunks;
+	for(size_t i = 0; i < 3; ++i) {
+		chunks.push_back(allocator.Create(16.0f, Vector3f(16.0f*i, 0, 0)));
+		ASSERT_ALWAYS((size_t)chunks.back().get()%Pages::Size() == 0, "Chunks must be page aligned.");
+		ASSERT_ALWAYS((void*)&chunks.back()->GetVoxels() == (void*)chunks.back().get(), "Voxels must be stored first.");
+	}
+	ASSERT_ALWAYS(allocator.GetUsedCount() == 3, "Allocator must count its chunks.");
+	ASSERT_ALWAYS(allocator.GetCapacity()*allocator.GetBlockSize() <= allocator.GetReservedBytes(), "Blocks must fit in the slabs.");
+	ASSERT_ALWAYS(allocator.GetOccupancy() > 0.0f && allocator.GetOccupancy() <= 1.0f, "Occupancy must be a ratio.");
+
+	// Last freed block is reused first.
+	TestChunk* freed = chunks[1].get();
+	chunks[1].reset();
+	ASSERT_ALWAYS(allocator.GetUsedCount() == 2, "Destroyed chunk must be given back.");
+	chunks[1] = allocator.Create(16.0f);
+	ASSERT_ALWAYS(chunks[1].get() == freed, "Freed block must be reused first.");
+
+	// Many chunks need more slabs.
+	const size_t capacity = allocator.GetCapacity();
+	while(chunks.size() <= capacity) chunks.push_back(allocator.Create(16.0f));
+	ASSERT_ALWAYS(allocator.GetCapacity() > capacity, "Allocator must grow.");
+
+	// Huge pages slabs are whole huge pages, backed by them or not.
+	ChunkAllocator<TestChunk> huge(true, 1);
+	ChunkPtr<TestChunk> hugeChunk = huge.Create(16.0f);
+	ASSERT_ALWAYS(huge.GetReservedBytes()%Pages::HUGE_SIZE == 0, "Huge pages slabs must be rounded to huge pages.");
+
+	// Chunks created by new are deleted.
+	ChunkPtr<TestChunk> alone(new TestChunk(16.0f));
+	chunks.clear();
+	ASSERT_ALWAYS(allocator.GetUsedCount() == 0, "Every chunk must be given back.");
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+/**
+ * \author Asso Corentin
+ * \Date May 15 2021
+ * \Desc Pool allocator of chunks, in page aligned slabs.
+ */
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "Util.hpp"
+
+namespace HyperV {
+
+namespace Pages {
+
+/** Size of a memory page, in bytes. */
+size_t Size();
+
+/** Size of a huge memory page, in bytes. */
+constexpr size_t HUGE_SIZE = 2 << 20;
+
+/**
+ * Map 'size' bytes of page aligned memory, nullptr on failure.
+ * With 'huge', huge pages are tried first, then transparent huge pages
+ * are asked for ; 'huge' is set to false if the mapping isn't backed
+ * by huge pages for sure.
+ */
+void* Map(size_t size, bool& huge);
+
+/** Unmap memory returned by Map. */
+void Unmap(void* pages, size_t size);
+
+} // namespace Pages
+
+template<typename CHUNK>
+class ChunkAllocator;
+
+/** Give a chunk back to its allocator, or delete it if it has none. */
+template<typename CHUNK>
+struct ChunkDeleter {
+	ChunkAllocator<CHUNK>* allocator = nullptr;
+
+	inline void operator() (CHUNK* chunk) const
+	{
+		if(allocator != nullptr) allocator->Destroy(chunk);
+		else delete chunk;
+	}
+};
+
+/** Owning pointer of a chunk, allocated by new or by a ChunkAllocator. */
+template<typename CHUNK>
+using ChunkPtr = std::unique_ptr<CHUNK, ChunkDeleter<CHUNK>>;
+
+/**
+ * Allocator of chunks of a single type. Chunks are placed into blocks,
+ * carved from big slabs of mapped pages, and blocks of destroyed chunks
+ * are reused last freed first, while their pages are still mapped and
+ * hot. Block are page aligned when a chunk is at least a page, so voxels
+ * stored first in the chunk are too.
+ * Memory of a block isn't cleared when it is reused, a chunk must
+ * be filled by its generator before being read.
+ * An allocator is not thread safe, and must outlive its chunks.
+ */
+template<typename CHUNK>
+class ChunkAllocator {
+private:
+	struct Slab {
+		void* pages;
+		size_t size;
+	};
+
+	std::vector<Slab> _slabs;
+
+	/** Blocks carved from the slabs and not used by a chunk. */
+	std::vector<void*> _freeBlocks;
+
+	/** Size of a block, in bytes. */
+	size_t _blockSize;
+
+	/** Size of a slab, in bytes. */
+	size_t _slabSize;
+
+	/** Number of blocks used by a chunk. */
+	size_t _used = 0;
+
+	/** Huge pages are asked for. */
+	bool _hugePages;
+
+	/** Every slab is backed by huge pages. */
+	bool _hugeBacked = true;
+
+	/** Map a new slab and carve it into free blocks. */
+	void Grow()
+	{
+		bool huge = _hugePages;
+		void* pages = Pages::Map(_slabSize, huge);
+		if(pages == nullptr) throw std::bad_alloc();
+		_hugeBacked = _hugeBacked && huge;
+		_slabs.push_back(Slab{pages, _slabSize});
+
+		// Pushed backward, so blocks are used in address order.
+		const size_t nBlocks = _slabSize/_blockSize;
+		for(size_t b = nBlocks; b > 0; --b)
+			_freeBlocks.push_back((char*)pages + (b-1)*_blockSize);
+	}
+
+public:
+	/**
+	 * Allocator with slabs of at least 'slabSize' bytes. With 'hugePages',
+	 * slabs are rounded up to huge pages, and backed by them if the system
+	 * allow it.
+	 */
+	explicit ChunkAllocator(bool hugePages = false, size_t slabSize = Pages::HUGE_SIZE) :
+		_hugePages(hugePages)
+	{
+		const size_t page = Pages::Size();
+		const size_t align = std::max(alignof(CHUNK), (size_t)64);
+		_blockSize = (sizeof(CHUNK) >= page)
+			? (sizeof(CHUNK) + page-1)/page*page
+			: (sizeof(CHUNK) + align-1)/align*align;
+
+		const size_t granularity = hugePages ? Pages::HUGE_SIZE : page;
+		_slabSize = std::max(slabSize, _blockSize);
+		_slabSize = (_slabSize + granularity-1)/granularity*granularity;
+	}
+
+	~ChunkAllocator()
+	{
+		ASSERT(_used == 0, "Chunks outlive their allocator.");
+		for(const Slab& slab : _slabs) Pages::Unmap(slab.pages, slab.size);
+	}
+
+	ChunkAllocator(const ChunkAllocator&) = delete;
+	ChunkAllocator& operator= (const ChunkAllocator&) = delete;
+
+	/** Construct a chunk into a free block. */
+	template<typename... Args>
+	ChunkPtr<CHUNK> Create(Args&&... args)
+	{
+		if(_freeBlocks.empty()) Grow();
+		void* block = _freeBlocks.back();
+		CHUNK* chunk = new (block) CHUNK(std::forward<Args>(args)...);
+		_freeBlocks.pop_back();
+		++_used;
+		return ChunkPtr<CHUNK>(chunk, ChunkDeleter<CHUNK>{this});
+	}
+
+	/** Destroy a chunk, its block is kept for the next one. */
+	void Destroy(CHUNK* chunk)
+	{
+		ASSERT(_used > 0, "Destroying a chunk not allocated here.");
+		chunk->~CHUNK();
+		_freeBlocks.push_back(chunk);
+		--_used;
+	}
+
+	/** Size of a block, in bytes. */
+	inline size_t GetBlockSize() const { return _blockSize; }
+
+	/** Number of chunks allocated. */
+	inline size_t GetUsedCount() const { return _used; }
+
+	/** Number of chunks fitting in the slabs already mapped. */
+	inline size_t GetCapacity() const { return _used + _freeBlocks.size(); }
+
+	/** Memory mapped by the allocator, in bytes. */
+	inline size_t GetReservedBytes() const { return _slabs.size()*_slabSize; }
+
+	/** Ratio of the mapped memory used by chunks. */
+	inline float GetOccupancy() const
+	{
+		return _slabs.empty() ? 0.0f : (float)(_used*sizeof(CHUNK))/GetReservedBytes();
+	}
+
+	/** Say if the slabs are backed by huge pages for sure. */
+	inline bool UsesHugePages() const { return _hugePages && _hugeBacked && !_slabs.empty(); }
+};
+
+/** Unit test for ChunkAllocator class. */
+void unitests_chunk_allocator();
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "ChunkManager.hpp"
+
+void HyperV::unitests_chunk_manager()
+{
+	using TestChunk = Chunk4<uint8>;
+	using Coords = ChunkManager<TestChunk>::Coords;
+
+	// Radius 1 see the chunk under the point of view and its 6 neighbors.
+	ChunkManager<TestChunk> manager(16, 1, 10, 2);
+	ASSERT_ALWAYS(manager.GetViewSize() == 7, "Radius 1 must see 7 chunks.");
+
+	size_t nLoads = 0, nUnloads = 0;
+	bool canUnload = true;
+	auto load = [&nLoads](TestChunk& chunk) { chunk.Fill(1); ++nLoads; };
+	auto unload = [&nUnloads, &canUnload](TestChunk&) { nUnloads += canUnload; return canUnload; };
+
+	ASSERT_ALWAYS(manager.Update(Vector3f(1, 2, -3), load, unload) == 7, "First update must load the view.");
+	ASSERT_ALWAYS(manager.Update(Vector3f(1, 2, -3), load, unload) == 0, "Loaded chunks must not be loaded again.");
+	TestChunk* center = manager.GetTerrain().GetChunk({0, 0, 0});
+	ASSERT_ALWAYS(center != nullptr && center->GetGridCoords() == (Coords{0, 0, 0}), "Chunk must know its grid coordinates.");
+	ASSERT_ALWAYS(manager.GetTerrain().GetChunk({1, 1, 0}) == nullptr, "Diagonal chunks are out of view.");
+
+	// Moving one chunk along x load 5 chunks, and unload the 2 least recently seen above capacity.
+	ASSERT_ALWAYS(manager.Update(Vector3f(16, 0, 0), load, unload) == 5, "Moving must load the new chunks in view.");
+	ASSERT_ALWAYS(manager.GetLoadedCount() == 10 && nUnloads == 2, "Chunks above capacity must be unloaded.");
+	ASSERT_ALWAYS(manager.GetPoolSize() == 2, "Unloaded chunks must be pooled.");
+	ASSERT_ALWAYS(manager.GetTerrain().GetChunk({0, 0, 0}) == center, "Chunks in view must stay loaded.");
+
+	// Chunks that can't be unloaded are kept, beyond capacity.
+	canUnload = false;
+	manager.Update(Vector3f(32, 0, 0), load, unload);
+	ASSERT_ALWAYS(manager.GetLoadedCount() == 15, "Chunks refusing to unload must stay loaded.");
+
+	// Loaded chunks reuse pooled ones.
+	canUnload = true;
+	manager.Update(Vector3f(32, 0, 0), load, unload);
+	ASSERT_ALWAYS(manager.GetLoadedCount() == 10 && manager.GetPoolSize() == 2, "Pool must not exceed its capacity.");
+	const size_t loadsBefore = nLoads;
+	manager.Update(Vector3f(48, 0, 0), load, unload);
+	ASSERT_ALWAYS(nLoads - loadsBefore == 5, "Moving must load the new chunks in view.");
+	ASSERT_ALWAYS(manager.GetPoolSize() == 2, "Pool must be drained then refilled.");
+	ASSERT_ALWAYS(manager.GetAllocator().GetUsedCount() == 12, "Loaded and pooled chunks must be allocated.");
+	ASSERT_ALWAYS(manager.GetTerrain().GetChunk({4, 0, 0})->GetPosition()[0] == 64.0f, "Loaded chunk must be placed on the grid.");
+
+	// Load budget is spent on the nearest chunks.
+	ChunkManager<TestChunk> budget(16, 1, 10, 0, 1);
+	ASSERT_ALWAYS(budget.Update(Vector3f(0, 0, 0), load, unload) == 1, "Loads must be limited by the budget.");
+	ASSERT_ALWAYS(budget.GetTerrain().GetChunk({0, 0, 0}) != nullptr, "Nearest chunk must be loaded first.");
+}
\ No newline at end of file
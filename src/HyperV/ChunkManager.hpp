@@ -0,0 +1,190 @@
+/**
+ * \author Asso Corentin
+ * \Date May 14 2021
+ * \Desc Streaming of the chunks of a terrain around a point of view.
+ */
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "Terrain.hpp"
+
+namespace HyperV {
+
+/**
+ * Load chunks of a terrain within a view radius around a point, and
+ * unload the least recently seen ones once too many are loaded.
+ * Unloaded chunks are kept in a pool, a chunk loaded later reuse one of
+ * them instead of allocating, with its old voxels : loading must
+ * overwrite them. Chunks beyond the pool give their block back to the
+ * allocator, which reuse it without clearing it either.
+ * The view radius is in chunks, chunks in view are never unloaded, so
+ * the capacity is exceeded if the view holds more chunks than it.
+ */
+template<typename CHUNK>
+class ChunkManager {
+public:
+	/** Number of dimension of the terrain. */
+	static constexpr size_t N = CHUNK::N;
+
+	using Coords = GridCoords<N>;
+
+private:
+	/** Storage of the chunks, it outlive them. */
+	ChunkAllocator<CHUNK> _allocator;
+
+	Terrain<CHUNK> _terrain;
+
+	/** View radius, in chunks. */
+	float _viewRadius;
+
+	/** Number of loaded chunks above which chunks out of view are unloaded. */
+	size_t _capacity;
+
+	/** Max number of unloaded chunks kept for reuse. */
+	size_t _poolCapacity;
+
+	/** Max number of chunks loaded by a single update. */
+	size_t _loadBudget;
+
+	/** Grid coordinates of loaded chunks, most recently in view first. */
+	std::list<Coords> _lru;
+	std::unordered_map<Coords, typename std::list<Coords>::iterator, GridCoordsHash<N>> _lruPos;
+
+	/** Unloaded chunks, kept for reuse. */
+	std::vector<ChunkPtr<CHUNK>> _pool;
+
+	/** Offsets of the grid cells in view radius, nearest first. */
+	std::vector<Coords> _viewOffsets;
+
+	/** Squared distance, in chunks, between two grid coordinates. */
+	static inline int64 Distance2(const Coords& a, const Coords& b)
+	{
+		int64 d2 = 0;
+		for(size_t n = 0; n < N; ++n) d2 += (a[n]-b[n])*(a[n]-b[n]);
+		return d2;
+	}
+
+	/** List offsets of the grid cells in view radius. */
+	void ComputeViewOffsets()
+	{
+		_viewOffsets.clear();
+		const int64 r = (int64)std::floor(_viewRadius);
+		const Coords zero{};
+		Coords offset;
+		offset.fill(-r);
+		while(true) {
+			if(Distance2(offset, zero) <= _viewRadius*_viewRadius) _viewOffsets.push_back(offset);
+			size_t n = 0;
+			while(n < N && offset[n] == r) offset[n++] = -r;
+			if(n == N) break;
+			++offset[n];
+		}
+		std::stable_sort(_viewOffsets.begin(), _viewOffsets.end(), [&zero](const Coords& a, const Coords& b) {
+			return Distance2(a, zero) < Distance2(b, zero);
+		});
+	}
+
+	/** Get an unloaded chunk from the pool, or a new one. */
+	inline ChunkPtr<CHUNK> Acquire()
+	{
+		if(_pool.empty()) return _allocator.Create(_terrain.GetChunkWorldSize());
+		ChunkPtr<CHUNK> chunk = std::move(_pool.back());
+		_pool.pop_back();
+		return chunk;
+	}
+
+public:
+	ChunkManager(float chunkWorldSize, float viewRadius, size_t capacity, size_t poolCapacity,
+		size_t loadBudget = std::numeric_limits<size_t>::max(), bool hugePages = false) :
+		_allocator(hugePages), _terrain(chunkWorldSize), _viewRadius(viewRadius), _capacity(capacity),
+		_poolCapacity(poolCapacity), _loadBudget(loadBudget)
+	{
+		ASSERT(viewRadius >= 0, "View radius must be positive.");
+		ComputeViewOffsets();
+	}
+
+	/** Storage of the chunks, loaded or pooled. */
+	inline const ChunkAllocator<CHUNK>& GetAllocator() const { return _allocator; }
+
+	/** Loaded chunks. */
+	inline Terrain<CHUNK>& GetTerrain() { return _terrain; }
+	inline const Terrain<CHUNK>& GetTerrain() const { return _terrain; }
+
+	/** View radius, in chunks. */
+	inline float GetViewRadius() const { return _viewRadius; }
+
+	/** Change view radius, chunks are loaded or unloaded by the next update. */
+	inline void SetViewRadius(float viewRadius)
+	{
+		ASSERT(viewRadius >= 0, "View radius must be positive.");
+		_viewRadius = viewRadius;
+		ComputeViewOffsets();
+	}
+
+	/** Number of chunks in view radius. */
+	inline size_t GetViewSize() const { return _viewOffsets.size(); }
+
+	/** Number of loaded chunks. */
+	inline size_t GetLoadedCount() const { return _terrain.GetSize(); }
+
+	/** Number of unloaded chunks kept for reuse. */
+	inline size_t GetPoolSize() const { return _pool.size(); }
+
+	/**
+	 * Load chunks in view around given world position, nearest first and
+	 * at most the load budget, calling load(chunk) once each is placed.
+	 * Then unload the least recently seen chunks out of view, while there
+	 * are more than the capacity, calling unload(chunk) first : if it
+	 * return false the chunk can't be unloaded yet and is skipped.
+	 * Return the number of chunks loaded.
+	 */
+	template<typename FL, typename FU>
+	size_t Update(const VectorNf<N>& worldPos, FL load, FU unload)
+	{
+		const Coords center = _terrain.GetGridCoordsAt(worldPos);
+
+		// Chunks in view, nearest first.
+		size_t loaded = 0;
+		for(const Coords& offset : _viewOffsets) {
+			Coords coords;
+			for(size_t n = 0; n < N; ++n) coords[n] = center[n] + offset[n];
+			auto pos = _lruPos.find(coords);
+			if(pos != _lruPos.end()) {
+				_lru.splice(_lru.begin(), _lru, pos->second);
+				continue;
+			}
+			if(loaded == _loadBudget) continue;
+
+			CHUNK& chunk = _terrain.InsertChunk(coords, Acquire());
+			_lru.push_front(coords);
+			_lruPos[coords] = _lru.begin();
+			load(chunk);
+			++loaded;
+		}
+
+		// Chunks out of view, least recently seen first.
+		auto it = _lru.end();
+		while(_terrain.GetSize() > _capacity && it != _lru.begin()) {
+			--it;
+			if(Distance2(*it, center) <= _viewRadius*_viewRadius) break;
+			CHUNK* chunk = _terrain.GetChunk(*it);
+			if(!unload(*chunk)) continue;
+
+			ChunkPtr<CHUNK> released = _terrain.ReleaseChunk(*it);
+			if(_pool.size() < _poolCapacity) _pool.push_back(std::move(released));
+			_lruPos.erase(*it);
+			it = _lru.erase(it);
+		}
+		return loaded;
+	}
+};
+
+/** Unit test for ChunkManager class. */
+void unitests_chunk_manager();
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "ChunkPipeline.hpp"
+
+void HyperV::unitests_chunk_pipeline()
+{
+	// Queue must keep every pushed value, in order for each producer.
+	{
+		MPSCQueue<size_t> queue;
+		ThreadPool pool(3);
+		const size_t perProducer = 1000;
+		pool.ParallelFor(4, [&queue](size_t p) {
+			for(size_t i = 0; i < perProducer; ++i) queue.Push(p*perProducer + i);
+		});
+		std::vector<size_t> last(4, 0);
+		size_t value, count = 0;
+		while(queue.Pop(value)) {
+			const size_t p = value/perProducer, i = value%perProducer + 1;
+			ASSERT_ALWAYS(i > last[p], "Values of a producer must be popped in order.");
+			last[p] = i;
+			++count;
+		}
+		ASSERT_ALWAYS(count == 4*perProducer, "Queue lost values.");
+	}
+
+	using TestChunk = Chunk4<uint8>;
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+	for(size_t nWorkers : {0, 2}) {
+		ThreadPool pool(nWorkers);
+		ChunkPipeline<TestChunk> pipeline(voxelSet, pool);
+		TestChunk a(4), b(4);
+
+		std::unordered_map<const TestChunk*, size_t> indices;
+		auto upload = [&indices](TestChunk& chunk, std::vector<ChunkPipeline<TestChunk>::Section>&& sections) {
+			ASSERT_ALWAYS(sections.size() == 1 && sections[0].index == 0, "Small chunk must have a single section.");
+			indices[&chunk] = sections[0].mesh.getIndices().size();
+		};
+		auto poll = [&pipeline, &upload]() {
+			while(pipeline.GetPending() > 0) {
+				if(pipeline.Poll(upload) == 0) std::this_thread::yield();
+			}
+		};
+
+		pipeline.Request(a, [](TestChunk& chunk) { chunk.Fill(3); });
+		pipeline.Request(b, [](TestChunk& chunk) { chunk.Fill(0); chunk.SetVoxel({1, 1, 1}, 3); });
+		ASSERT_ALWAYS(pipeline.IsBusy(a) && pipeline.IsBusy(b), "Requested chunks must be busy.");
+		poll();
+		ASSERT_ALWAYS(!pipeline.IsBusy(a), "Polled chunks must not be busy.");
+		ASSERT_ALWAYS(indices[&a] == 6*2, "Full chunk must be meshed with 6 greedy faces.");
+		ASSERT_ALWAYS(indices[&b] == 6*2, "Single voxel must be meshed with 6 faces.");
+
+		// Requests on a busy chunk are merged into a single job, keeping the generator.
+		indices.clear();
+		size_t nMeshes = 0;
+		pipeline.Request(a, [](TestChunk& chunk) { chunk.Fill(0); });
+		pipeline.Request(a, [](TestChunk& chunk) { chunk.SetVoxel({0, 0, 0}, 3); });
+		pipeline.Request(a);
+		while(pipeline.GetPending() > 0) nMeshes += pipeline.Poll(upload);
+		ASSERT_ALWAYS(nMeshes == 2, "Requests on a busy chunk must be merged.");
+		ASSERT_ALWAYS(indices[&a] == 6*2, "Last mesh must come from the delayed generator.");
+		ASSERT_ALWAYS(a.GetVoxel({0, 0, 0}) == 3 && a.GetVoxel({1, 1, 1}) == 0, "Generators must run in order.");
+
+		// Chunks of a terrain are culled against their neighbors, which are meshed again when they load or are edited.
+		Terrain<TestChunk> terrain(4);
+		ChunkPipeline<TestChunk> culled(voxelSet, terrain, pool);
+		TestChunk& left = terrain.CreateChunk({0, 0, 0});
+		TestChunk& right = terrain.CreateChunk({1, 0, 0});
+		right.Fill(0);
+		std::unordered_map<const TestChunk*, size_t> uploads;
+		indices.clear();
+		auto pollCulled = [&culled, &upload, &uploads]() {
+			while(culled.GetPending() > 0) {
+				if(culled.Poll([&upload, &uploads](TestChunk& chunk, std::vector<ChunkPipeline<TestChunk>::Section>&& sections) {
+					++uploads[&chunk];
+					upload(chunk, std::move(sections));
+				}) == 0) std::this_thread::yield();
+			}
+		};
+		culled.Request(left, [](TestChunk& chunk) { chunk.Fill(3); });
+		pollCulled();
+		ASSERT_ALWAYS(indices[&left] == 6*2, "Chunk next to air must show all its faces.");
+		culled.Request(right, [](TestChunk& chunk) { chunk.Fill(3); });
+		pollCulled();
+		ASSERT_ALWAYS(indices[&right] == 5*2, "Face against a full neighbor must be culled.");
+		ASSERT_ALWAYS(uploads[&left] == 2 && indices[&left] == 5*2, "Loading a neighbor must mesh again the face against it.");
+
+		right.SetVoxel({0, 1, 1}, 0);
+		culled.Request(right);
+		pollCulled();
+		ASSERT_ALWAYS(uploads[&left] == 3 && indices[&left] == 6*2, "Editing the face of a neighbor must mesh again the face against it.");
+		right.SetVoxel({3, 1, 1}, 0);
+		culled.Request(right);
+		pollCulled();
+		ASSERT_ALWAYS(uploads[&left] == 3, "Edits away from a neighbor must not mesh it again.");
+		ASSERT_ALWAYS(right.TakeEditedFaces().none() && left.TakeEditedFaces().none(), "Polled jobs must take the edited faces.");
+	}
+
+	// Only sections around edits are handed back.
+	using BigChunk = Chunk32<uint8>;
+	ThreadPool pool(2);
+	ChunkPipeline<BigChunk> pipeline(voxelSet, pool);
+	std::unique_ptr<BigChunk> big(new BigChunk(32));
+	std::vector<size_t> changed;
+	auto upload = [&changed](BigChunk&, std::vector<ChunkPipeline<BigChunk>::Section>&& sections) {
+		changed.clear();
+		for(const auto& section : sections) {
+			changed.push_back(section.index);
+			ASSERT_ALWAYS(section.mesh.getIndices().empty() == section.box.isEmpty(), "Box must bound the section.");
+		}
+	};
+	auto poll = [&pipeline, &upload]() {
+		while(pipeline.GetPending() > 0) {
+			if(pipeline.Poll(upload) == 0) std::this_thread::yield();
+		}
+	};
+	pipeline.Request(*big, [](BigChunk& chunk) { chunk.Fill(0); chunk.SetVoxel({3, 3, 3}, 3); });
+	poll();
+	ASSERT_ALWAYS(changed.size() == BigChunk::N_BRICKS, "First job must hand back every section.");
+	big->SetVoxel({20, 20, 20}, 3);
+	pipeline.Request(*big);
+	poll();
+	ASSERT_ALWAYS(changed.size() == 1 && changed[0] == BigChunk::BrickOf({20, 20, 20}), "Remesh must hand back the edited section only.");
+
+	// A forgotten chunk is meshed again from scratch.
+	pipeline.Forget(*big);
+	pipeline.Request(*big);
+	poll();
+	ASSERT_ALWAYS(changed.size() == BigChunk::N_BRICKS, "Forgotten chunk must hand back every section.");
+
+	// Packed sections are handed back packed, with the frame of their chunk.
+	ChunkPipeline<BigChunk, PackedMeshBuilder> packed(voxelSet, pool);
+	size_t nQuads = 0;
+	packed.Request(*big);
+	while(packed.GetPending() > 0) {
+		if(packed.Poll([&nQuads, &big](BigChunk&, std::vector<ChunkPipeline<BigChunk, PackedMeshBuilder>::Section>&& sections) {
+			for(const auto& section : sections) {
+				nQuads += section.mesh.GetQuadCount();
+				ASSERT_ALWAYS(section.mesh.GetQuadCount() == 0 || section.mesh.GetOrigin() == big->GetOrigin(), "Packed section must keep the origin of its chunk.");
+				ASSERT_ALWAYS((section.mesh.GetQuadCount() == 0) == section.box.isEmpty(), "Box must bound the section.");
+			}
+		}) == 0) std::this_thread::yield();
+	}
+	ASSERT_ALWAYS(nQuads == 2*6, "Packed pipeline must mesh the two voxels.");
+	ASSERT_ALWAYS(packed.GetMeshMemoryUsage() < pipeline.GetMeshMemoryUsage(), "Packed sections must be smaller.");
+}
\ No newline at end of file
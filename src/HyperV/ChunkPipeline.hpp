@@ -0,0 +1,329 @@
+/**
+ * \author Asso Corentin
+ * \Date May 13 2021
+ * \Desc Asynchronous generation and meshing of chunks.
+ */
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Chunk.hpp"
+#include "Terrain.hpp"
+#include "ThreadPool.hpp"
+
+namespace HyperV {
+
+/**
+ * Unbounded lock-free queue, with many producers and a single consumer.
+ * Producers link their node at the head with one exchange, the consumer
+ * walk nodes from the tail, so none of them ever wait on a lock.
+ * A push is visible to the consumer once its node is linked, a pop
+ * can miss a node being linked and return false before it is.
+ */
+template<typename T>
+class MPSCQueue {
+private:
+	struct Node {
+		std::atomic<Node*> next{nullptr};
+		T value;
+	};
+
+	/** Last pushed node, written by producers. */
+	std::atomic<Node*> _head;
+
+	/** Node before the next to pop, only touched by the consumer. */
+	Node* _tail;
+
+public:
+	MPSCQueue() : _head(new Node()), _tail(_head.load(std::memory_order_relaxed)) {}
+
+	~MPSCQueue()
+	{
+		while(_tail != nullptr) {
+			Node* next = _tail->next.load(std::memory_order_relaxed);
+			delete _tail;
+			_tail = next;
+		}
+	}
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator= (const MPSCQueue&) = delete;
+
+	/** Add a value, can be called from any thread. */
+	void Push(T value)
+	{
+		Node* node = new Node();
+		node->value = std::move(value);
+		Node* prev = _head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	/** Take the oldest value, only from the consumer thread. Return false if there is none. */
+	bool Pop(T& value)
+	{
+		Node* next = _tail->next.load(std::memory_order_acquire);
+		if(next == nullptr) return false;
+		value = std::move(next->value);
+		delete _tail;
+		_tail = next;
+		return true;
+	}
+};
+
+/**
+ * Pipeline generating and meshing chunks on the workers of a thread pool,
+ * then handing meshes back to the thread owning the pipeline (the render
+ * thread), which upload them when it poll the pipeline.
+ * Each chunk keep a sectioned mesh, only the sections of edited bricks are
+ * rebuilt, and only those are handed back, so they are uploaded again
+ * alone. The brick occupancy of the chunk is updated too, for raycasts.
+ * Request and Poll are called from the render thread only, and never wait
+ * on the workers. A chunk has at most one job in flight : requesting it
+ * again while it is busy queue a single job, run once the first is
+ * polled. The render thread must not touch a chunk while it is busy.
+ * Given a terrain, faces on the border of a chunk are culled against its
+ * neighbors : their layers touching the chunk are copied when the job
+ * start, (neighbors being generated count as air). Once a job is polled,
+ * the faces of the neighbors touching the edited faces of its chunk are
+ * meshed again.
+ * With a PackedMeshBuilder, sections are kept packed between jobs, and
+ * handed back packed, to be uploaded as they are and decoded by shaders.
+ */
+template<typename CHUNK, typename BUILDER = MeshBuilder>
+class ChunkPipeline {
+public:
+	using VoxelID = typename CHUNK::VoxelID;
+
+	/** Fill a chunk, run on a worker. */
+	using Generator = std::function<void(CHUNK&)>;
+
+	/** Mesh of a section : a TriangleMesh, or the packed quads with their frame. */
+	using SectionMesh = typename std::conditional<std::is_same<BUILDER, PackedMeshBuilder>::value, PackedMeshBuilder, TriangleMesh>::type;
+
+	/** Section of the mesh of a chunk, ready to be uploaded. Its mesh is empty if it has no faces. */
+	struct Section {
+		size_t index;
+		SectionMesh mesh;
+		Aabb box;
+	};
+
+	/** Sections of a chunk changed by a job. */
+	struct Result {
+		CHUNK* chunk = nullptr;
+		std::vector<Section> sections;
+	};
+
+private:
+	/** Jobs of a chunk, seen from the render thread. */
+	struct State {
+		bool busy = false;
+		bool generating = false;
+		bool again = false;
+		Generator next;
+
+		/** Faces to make stale before the delayed job. */
+		std::bitset<CHUNK::N_NEIGHBOR> staleFaces;
+	};
+
+	const VoxelSet<VoxelID>& _voxelSet;
+	ThreadPool& _pool;
+
+	/** Terrain holding the chunks, to find their neighbors, nullptr if they have none. */
+	Terrain<CHUNK>* _terrain = nullptr;
+
+	MPSCQueue<Result> _done;
+	std::unordered_map<CHUNK*, State> _states;
+
+	/** Mesh of each chunk, a job only touch the one of its chunk. */
+	std::unordered_map<CHUNK*, BasicSectionedMesh<BUILDER>> _meshes;
+
+	/** Number of jobs submitted and not pushed into _done yet. */
+	std::atomic<size_t> _running{0};
+
+	/** Mesh of a section, ready to be uploaded. Packed sections are copied, they are kept for the next jobs. */
+	inline SectionMesh ToSectionMesh(const BasicSectionedMesh<BUILDER>& mesh, size_t section) const
+	{
+		if constexpr(std::is_same<BUILDER, PackedMeshBuilder>::value) return mesh.GetSection(section);
+		else return mesh.SectionToTriangleMesh(section);
+	}
+
+	/** Neighbors of a chunk inside the terrain, all nullptr if it isn't in it. */
+	inline typename CHUNK::NeighborChunks NeighborsOf(const CHUNK& chunk) const
+	{
+		typename CHUNK::NeighborChunks neighbors{};
+		if(_terrain == nullptr || _terrain->GetChunk(chunk.GetGridCoords()) != &chunk) return neighbors;
+		return _terrain->GetNeighbors(chunk.GetGridCoords());
+	}
+
+	/** Say if a job generating given chunk is in flight. */
+	inline bool IsGenerating(const CHUNK& chunk) const
+	{
+		auto it = _states.find(const_cast<CHUNK*>(&chunk));
+		return it != _states.end() && it->second.busy && it->second.generating;
+	}
+
+	/** Start the job of a chunk, copying the layers of its neighbors. */
+	void Launch(CHUNK* chunk, Generator generate)
+	{
+		State& state = _states[chunk];
+		state.busy = true;
+		state.generating = (bool)generate;
+		BasicSectionedMesh<BUILDER>* mesh = &_meshes[chunk];
+
+		typename CHUNK::NeighborChunks neighbors = NeighborsOf(*chunk);
+		for(auto& neighbor : neighbors)
+			if(neighbor != nullptr && IsGenerating(*neighbor)) neighbor = nullptr;
+		typename CHUNK::NeighborFaces faces = CHUNK::CopyNeighborFaces(neighbors);
+
+		_running.fetch_add(1, std::memory_order_relaxed);
+		_pool.Submit([this, chunk, mesh, generate = std::move(generate), faces = std::move(faces)]() {
+			if(generate) generate(*chunk);
+			chunk->Remesh(_voxelSet, *mesh, faces);
+			chunk->UpdateBrickOccupancy();
+
+			Result result;
+			result.chunk = chunk;
+			for(size_t section : mesh->TakeChanged())
+				result.sections.push_back(Section{section, ToSectionMesh(*mesh, section), mesh->GetBox(section)});
+			_done.Push(std::move(result));
+			_running.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+public:
+	ChunkPipeline(const VoxelSet<VoxelID>& voxelSet, ThreadPool& pool = ThreadPool::GetGlobal()) :
+		_voxelSet(voxelSet), _pool(pool)
+	{}
+
+	/** Pipeline of the chunks of a terrain, culled against their neighbors. */
+	ChunkPipeline(const VoxelSet<VoxelID>& voxelSet, Terrain<CHUNK>& terrain, ThreadPool& pool = ThreadPool::GetGlobal()) :
+		_voxelSet(voxelSet), _pool(pool), _terrain(&terrain)
+	{}
+
+	/** Wait for jobs in flight, their results are dropped. */
+	~ChunkPipeline()
+	{
+		while(_running.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+	}
+
+	ChunkPipeline(const ChunkPipeline&) = delete;
+	ChunkPipeline& operator= (const ChunkPipeline&) = delete;
+
+	/**
+	 * Generate then mesh a chunk on a worker, without generator only the
+	 * edited bricks of the chunk are meshed again. If the chunk is busy,
+	 * the job is delayed, and a delayed generator is not replaced by a
+	 * remesh.
+	 */
+	void Request(CHUNK& chunk, Generator generate = Generator())
+	{
+		State& state = _states[&chunk];
+		if(!state.busy) {
+			Launch(&chunk, std::move(generate));
+			return;
+		}
+		state.again = true;
+		if(generate) state.next = std::move(generate);
+	}
+
+	/**
+	 * Mesh again the sections on a face of a chunk, (E_NEIGHBOR order),
+	 * as the neighbor behind it changed. Delayed if the chunk is busy.
+	 */
+	void RequestFace(CHUNK& chunk, size_t face)
+	{
+		State& state = _states[&chunk];
+		if(!state.busy) {
+			chunk.MarkFaceStale(face);
+			Launch(&chunk, Generator());
+			return;
+		}
+		state.again = true;
+		state.staleFaces.set(face);
+	}
+
+	/**
+	 * Drop the mesh of a chunk, before it is destroyed or reused for another
+	 * place, so its next job build every section. The chunk must not be busy.
+	 */
+	inline void Forget(const CHUNK& chunk)
+	{
+		ASSERT(!IsBusy(chunk), "Forgetting a busy chunk.");
+		_meshes.erase(const_cast<CHUNK*>(&chunk));
+	}
+
+	/** Say if a job of given chunk is in flight or delayed. */
+	inline bool IsBusy(const CHUNK& chunk) const
+	{
+		auto it = _states.find(const_cast<CHUNK*>(&chunk));
+		return it != _states.end() && it->second.busy;
+	}
+
+	/**
+	 * Memory used by the meshes kept between jobs, in bytes.
+	 * Must not be called while a job is in flight.
+	 */
+	inline size_t GetMeshMemoryUsage() const
+	{
+		size_t bytes = 0;
+		for(const auto& mesh : _meshes) bytes += mesh.second.GetMemoryUsage();
+		return bytes;
+	}
+
+	/** Number of chunks with a job in flight or delayed. */
+	inline size_t GetPending() const
+	{
+		size_t pending = 0;
+		for(const auto& state : _states) pending += state.second.busy;
+		return pending;
+	}
+
+	/**
+	 * Call upload(chunk, sections) for at most 'max' jobs done, with the
+	 * sections they changed, and start delayed jobs of their chunks, then
+	 * the jobs of the neighbors touching their edited faces.
+	 * Return the number of jobs uploaded.
+	 */
+	template<typename F>
+	size_t Poll(F upload, size_t max = std::numeric_limits<size_t>::max())
+	{
+		size_t count = 0;
+		Result result;
+		while(count < max && _done.Pop(result)) {
+			CHUNK* chunk = result.chunk;
+			auto it = _states.find(chunk);
+			ASSERT(it != _states.end() && it->second.busy, "Mesh of a chunk without job.");
+			upload(*chunk, std::move(result.sections));
+			++count;
+
+			const std::bitset<CHUNK::N_NEIGHBOR> edited = chunk->TakeEditedFaces();
+			if(it->second.again) {
+				Generator next = std::move(it->second.next);
+				for(size_t face = 0; face < CHUNK::N_NEIGHBOR; ++face)
+					if(it->second.staleFaces[face]) chunk->MarkFaceStale(face);
+				it->second = State();
+				Launch(chunk, std::move(next));
+			} else _states.erase(it);
+
+			// Neighbors never meshed will see this chunk when they are.
+			const typename CHUNK::NeighborChunks neighbors = NeighborsOf(*chunk);
+			for(size_t face = 0; face < CHUNK::N_NEIGHBOR; ++face) {
+				CHUNK* neighbor = const_cast<CHUNK*>(neighbors[face]);
+				if(edited[face] && neighbor != nullptr && _meshes.count(neighbor) > 0)
+					RequestFace(*neighbor, face^1);
+			}
+		}
+		return count;
+	}
+};
+
+/** Unit test for ChunkPipeline class. */
+void unitests_chunk_pipeline();
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "Curve.hpp"
+#include "Array.hpp"
+
+namespace HyperV {
+
+/** Check encode/decode of a morton code is a bijection on a N-cube. */
+template<size_t N, size_t BITS>
+static void unitests_morton()
+{
+	constexpr uint64 SIZE = ((uint64)0b1) << (N*BITS);
+	std::array<size_t, N> coords;
+	for(uint64 index = 0; index < SIZE; ++index) {
+		Morton::Decode<N, BITS>(coords, index);
+		for(size_t k = 0; k < N; ++k) {
+			ASSERT_ALWAYS(coords[k] < (((size_t)0b1) << BITS), "Morton decode out of bounds.");
+			// Bit i of axis k must be bit i*N+k of the index.
+			for(size_t i = 0; i < BITS; ++i)
+				ASSERT_ALWAYS(((coords[k] >> i) & 0b1) == ((index >> (i*N+k)) & 0b1), "Morton bits are not interleaved.");
+		}
+		const uint64 encoded = Morton::Encode<N, BITS>(coords);
+		ASSERT_ALWAYS(encoded == index, "Morton encode is not the inverse of decode.");
+	}
+}
+
+/**
+ * Check encode/decode of a hilbert index is a bijection on a N-cube,
+ * and that two consecutive index are neighbors in space.
+ */
+template<size_t N, size_t BITS>
+static void unitests_hilbert()
+{
+	constexpr uint64 SIZE = ((uint64)0b1) << (N*BITS);
+	std::array<size_t, N> coords{}, previous{};
+	for(uint64 index = 0; index < SIZE; ++index) {
+		Hilbert::Decode<N, BITS>(coords, index);
+		const uint64 encoded = Hilbert::Encode<N, BITS>(coords);
+		ASSERT_ALWAYS(encoded == index, "Hilbert encode is not the inverse of decode.");
+		if(index == 0) {
+			ASSERT_ALWAYS(Math::AllEqTo<N>(0, coords), "Hilbert curve must start at the origin.");
+		} else {
+			size_t dist = 0;
+			for(size_t k = 0; k < N; ++k)
+				dist += (coords[k] > previous[k]) ? coords[k]-previous[k] : previous[k]-coords[k];
+			ASSERT_ALWAYS(dist == 1, "Consecutive hilbert index must be neighbors.");
+		}
+		previous = coords;
+	}
+}
+
+} // namespace HyperV
+
+void HyperV::unitests_curve()
+{
+	unitests_morton<1, 5>();
+	unitests_morton<2, 1>();
+	unitests_morton<2, 5>();
+	unitests_morton<3, 3>();
+	unitests_morton<3, 5>();
+	unitests_morton<4, 3>();
+	unitests_morton<5, 2>();
+
+	unitests_hilbert<1, 4>();
+	unitests_hilbert<2, 1>();
+	unitests_hilbert<2, 5>();
+	unitests_hilbert<3, 1>();
+	unitests_hilbert<3, 4>();
+	unitests_hilbert<4, 3>();
+	unitests_hilbert<5, 2>();
+
+	// Wide indices, only check the corners.
+	std::array<size_t, 3> coords = {(1<<21)-1, 0, (1<<21)-1};
+	const uint64 encoded = Morton::Encode<3, 21>(coords);
+	ASSERT_ALWAYS(encoded == 0x5B6DB6DB6DB6DB6DUL, "Morton encode 3D 63 bits failed.");
+	std::array<size_t, 3> decoded;
+	Morton::Decode<3, 21>(decoded, encoded);
+	ASSERT_ALWAYS(Math::Equal<3>(decoded, coords), "Morton decode 3D 63 bits failed.");
+
+	// Z ordered array must follow the curve.
+	using Array = ZArray3D<uint8, 8>;
+	for(size_t index = 0; index < Array::SIZE; ++index) {
+		auto c = Array::CoordsFor(index);
+		ASSERT_ALWAYS(Array::IndexAt(c) == index, "ZArray index and coordinates mismatch.");
+		ASSERT_ALWAYS(Array::IndexAt(c[0], c[1], c[2]) == index, "ZArray index and coordinates mismatch.");
+	}
+	ASSERT_ALWAYS(Array::IndexAt(1, 0, 0) == 1, "ZArray X axis must be the least significant.");
+	ASSERT_ALWAYS(Array::IndexAt(0, 1, 0) == 2, "ZArray Y axis is misplaced.");
+	ASSERT_ALWAYS(Array::IndexAt(0, 0, 1) == 4, "ZArray Z axis is misplaced.");
+	ASSERT_ALWAYS(Array::IndexAt(1, 1, 1) == 7, "ZArray first octant is not contiguous.");
+
+	// U ordered array must follow the curve.
+	using HArray = UArray2D<uint8, 16>;
+	for(size_t index = 0; index < HArray::SIZE; ++index) {
+		auto c = HArray::CoordsFor(index);
+		ASSERT_ALWAYS(HArray::IndexAt(c) == index, "UArray index and coordinates mismatch.");
+		ASSERT_ALWAYS(HArray::IndexAt(c[0], c[1]) == index, "UArray index and coordinates mismatch.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+/**
+ * \author Asso Corentin
+ * \Date May 3 2021
+ * \Desc Space filling curves used to map n-space to 1D.
+ */
+#pragma once
+
+#include <array>
+#include "Util.hpp"
+
+#if defined(__BMI2__) && !defined(HYPERV_NO_BMI2)
+#include <immintrin.h>
+#define HYPERV_USE_BMI2
+#endif
+
+namespace HyperV {
+
+/**
+ * Morton code (Z-order curve) for N dimensions.
+ * Bits of each coordinate are interleaved : bit i of axis k
+ * goes to bit i*N+k of the index, so axis X is the least significant.
+ * - N : Number of dimensions.
+ * - BITS : Number of bits per coordinate, log2 of the side of the space.
+ */
+namespace Morton {
+
+/**
+ * Number of shift-and-mask steps needed to spread BITS bits,
+ * it's ceil(log2(BITS)).
+ */
+static inline constexpr size_t Levels(size_t bits)
+{
+	size_t levels = 0;
+	while((((size_t)0b1) << levels) < bits) ++levels;
+	return levels;
+}
+
+/**
+ * Magic bits masks, generated at compile time.
+ * SPREAD[j] is where the BITS bits of a coordinate lie once every
+ * step with a shift of 2^j or more has been done. SPREAD[LEVELS] is
+ * the untouched coordinate, SPREAD[0] is the fully spread coordinate.
+ * AXIS[k] is the mask of the bits of axis k inside an index.
+ */
+template<size_t N, size_t BITS>
+struct Masks {
+	static constexpr size_t LEVELS = Levels(BITS);
+
+	static constexpr std::array<uint64, LEVELS+1> GenSpread()
+	{
+		std::array<uint64, LEVELS+1> masks{};
+		for(size_t j = 0; j <= LEVELS; ++j) {
+			const uint64 low = (((uint64)0b1) << j) - 1;
+			for(uint64 i = 0; i < BITS; ++i)
+				masks[j] |= ((uint64)0b1) << (i + (N-1)*(i & ~low));
+		}
+		return masks;
+	}
+
+	static constexpr std::array<uint64, N> GenAxis()
+	{
+		std::array<uint64, N> masks{};
+		for(size_t k = 0; k < N; ++k)
+			masks[k] = GenSpread()[0] << k;
+		return masks;
+	}
+
+	static constexpr std::array<uint64, LEVELS+1> SPREAD = GenSpread();
+	static constexpr std::array<uint64, N> AXIS = GenAxis();
+
+	static_assert(N > 0, "Morton code need at least one dimension.");
+	static_assert(N*BITS <= 64, "Morton code doesn't fit inside a 64 bits index.");
+};
+
+/** Insert N-1 zeros between each of the BITS lower bits of x. */
+template<size_t N, size_t BITS>
+static inline uint64 Spread(uint64 x)
+{
+	using M = Masks<N, BITS>;
+	x &= M::SPREAD[M::LEVELS];
+	if constexpr (N > 1) {
+		for(size_t j = M::LEVELS; j-- > 0;)
+			x = (x | (x << ((N-1) << j))) & M::SPREAD[j];
+	}
+	return x;
+}
+
+/** Inverse of Spread, gather each N-th bit of x into the lower bits. */
+template<size_t N, size_t BITS>
+static inline uint64 Compact(uint64 x)
+{
+	using M = Masks<N, BITS>;
+	x &= M::SPREAD[0];
+	if constexpr (N > 1) {
+		for(size_t j = 0; j < M::LEVELS; ++j)
+			x = (x | (x >> ((N-1) << j))) & M::SPREAD[j+1];
+	}
+	return x;
+}
+
+/** Get the morton index of given coordinates. */
+template<size_t N, size_t BITS, typename V>
+static inline uint64 Encode(const V& coords)
+{
+	uint64 index = 0;
+	for(size_t k = 0; k < N; ++k) {
+#ifdef HYPERV_USE_BMI2
+		index |= _pdep_u64(coords[k], Masks<N, BITS>::AXIS[k]);
+#else
+		index |= Spread<N, BITS>(coords[k]) << k;
+#endif
+	}
+	return index;
+}
+
+/** Get the coordinates of given morton index. */
+template<size_t N, size_t BITS, typename V>
+static inline V& Decode(V& coords, uint64 index)
+{
+	for(size_t k = 0; k < N; ++k) {
+#ifdef HYPERV_USE_BMI2
+		coords[k] = _pext_u64(index, Masks<N, BITS>::AXIS[k]);
+#else
+		coords[k] = Compact<N, BITS>(index >> k);
+#endif
+	}
+	return coords;
+}
+
+} // namespace Morton
+
+/**
+ * Hilbert curve for N dimensions.
+ * Use the state machine of Hamilton's "Compact Hilbert Indices" : at each
+ * level of the curve, the N bits taken from the coordinates (an orthant)
+ * are transformed by the current state (entry point e, direction d) into
+ * an N bits digit of the index, and a new state.
+ * For N <= MAX_TABLE_N the transitions are precomputed at compile time
+ * inside tables, otherwise they are computed on the fly.
+ * - N : Number of dimensions.
+ * - BITS : Number of bits per coordinate, log2 of the side of the space.
+ */
+namespace Hilbert {
+
+/** Above this number of dimension, tables would be too large. */
+constexpr size_t MAX_TABLE_N = 4;
+
+/** Transformations used by the Hilbert curve on N bits words. */
+template<size_t N>
+struct Transform {
+	static constexpr uint64 MASK = (((uint64)0b1) << N) - 1;
+
+	/** Number of states (e, d) of the curve. */
+	static constexpr size_t N_STATES = (((size_t)0b1) << N) * N;
+
+	static constexpr uint64 Rotr(uint64 x, size_t r)
+	{
+		r %= N;
+		if(r == 0) return x;
+		return ((x >> r) | (x << (N-r))) & MASK;
+	}
+
+	static constexpr uint64 Rotl(uint64 x, size_t r)
+	{
+		r %= N;
+		if(r == 0) return x;
+		return ((x << r) | (x >> (N-r))) & MASK;
+	}
+
+	static constexpr uint64 Gray(uint64 i) { return i ^ (i >> 1); }
+
+	static constexpr uint64 GrayInverse(uint64 g)
+	{
+		uint64 i = g;
+		for(size_t shift = 1; shift < N; ++shift) i ^= g >> shift;
+		return i;
+	}
+
+	static constexpr size_t TrailingSetBits(uint64 i)
+	{
+		size_t n = 0;
+		while(i & 0b1) { ++n; i >>= 1; }
+		return n;
+	}
+
+	/** Entry point of the sub-cube i. */
+	static constexpr uint64 Entry(uint64 i)
+	{
+		if(i == 0) return 0;
+		return Gray(2*((i-1)/2));
+	}
+
+	/** Intra direction of the sub-cube i. */
+	static constexpr size_t Direction(uint64 i)
+	{
+		if(i == 0) return 0;
+		if(i & 0b1) return TrailingSetBits(i) % N;
+		return TrailingSetBits(i-1) % N;
+	}
+
+	/** Go to the next state, after visiting the sub-cube w. */
+	static constexpr size_t Next(size_t state, uint64 w)
+	{
+		uint64 e = state / N;
+		size_t d = state % N;
+		e ^= Rotl(Entry(w), d+1);
+		d = (d + Direction(w) + 1) % N;
+		return e*N + d;
+	}
+
+	/** Orthant l to index digit, for given state. */
+	static constexpr uint64 EncodeDigit(size_t state, uint64 l)
+	{
+		return GrayInverse(Rotr(l ^ (state / N), state % N + 1));
+	}
+
+	/** Index digit w to orthant, for given state. */
+	static constexpr uint64 DecodeDigit(size_t state, uint64 w)
+	{
+		return Rotl(Gray(w), state % N + 1) ^ (state / N);
+	}
+};
+
+/**
+ * Transition tables, generated at compile time.
+ * Each entry store the output digit in the N lower bits,
+ * and the next state in the higher bits.
+ */
+template<size_t N>
+struct Tables {
+	using TF = Transform<N>;
+	using Entries = std::array<std::array<uint16, ((size_t)0b1) << N>, TF::N_STATES>;
+
+	static constexpr Entries GenEncode()
+	{
+		Entries table{};
+		for(size_t s = 0; s < TF::N_STATES; ++s)
+			for(uint64 l = 0; l <= TF::MASK; ++l) {
+				const uint64 w = TF::EncodeDigit(s, l);
+				table[s][l] = w | (TF::Next(s, w) << N);
+			}
+		return table;
+	}
+
+	static constexpr Entries GenDecode()
+	{
+		Entries table{};
+		for(size_t s = 0; s < TF::N_STATES; ++s)
+			for(uint64 w = 0; w <= TF::MASK; ++w)
+				table[s][w] = TF::DecodeDigit(s, w) | (TF::Next(s, w) << N);
+		return table;
+	}
+
+	static constexpr Entries ENCODE = GenEncode();
+	static constexpr Entries DECODE = GenDecode();
+
+	static_assert(N <= MAX_TABLE_N, "Hilbert's tables are too large for this dimension.");
+};
+
+/**
+ * Get the hilbert index of given coordinates.
+ * Orthants of each level are the N bits groups of the morton code.
+ */
+template<size_t N, size_t BITS, typename V>
+static inline uint64 Encode(const V& coords)
+{
+	if constexpr (N == 1) return coords[0];
+	else {
+		using TF = Transform<N>;
+		const uint64 morton = Morton::Encode<N, BITS>(coords);
+		uint64 index = 0;
+		size_t state = 0;
+		for(size_t i = BITS; i-- > 0;) {
+			const uint64 l = (morton >> (i*N)) & TF::MASK;
+			if constexpr (N <= MAX_TABLE_N) {
+				const uint16 entry = Tables<N>::ENCODE[state][l];
+				index = (index << N) | (entry & TF::MASK);
+				state = entry >> N;
+			} else {
+				const uint64 w = TF::EncodeDigit(state, l);
+				index = (index << N) | w;
+				state = TF::Next(state, w);
+			}
+		}
+		return index;
+	}
+}
+
+/** Get the coordinates of given hilbert index. */
+template<size_t N, size_t BITS, typename V>
+static inline V& Decode(V& coords, uint64 index)
+{
+	if constexpr (N == 1) {
+		coords[0] = index;
+		return coords;
+	} else {
+		using TF = Transform<N>;
+		uint64 morton = 0;
+		size_t state = 0;
+		for(size_t i = BITS; i-- > 0;) {
+			const uint64 w = (index >> (i*N)) & TF::MASK;
+			if constexpr (N <= MAX_TABLE_N) {
+				const uint16 entry = Tables<N>::DECODE[state][w];
+				morton = (morton << N) | (entry & TF::MASK);
+				state = entry >> N;
+			} else {
+				morton = (morton << N) | TF::DecodeDigit(state, w);
+				state = TF::Next(state, w);
+			}
+		}
+		return Morton::Decode<N, BITS>(coords, morton);
+	}
+}
+
+} // namespace Hilbert
+
+#include "Curve.inl"
+
+/** Unit test for space filling curves. */
+void unitests_curve();
+
+} // namespace HyperV
\ No newline at end of file
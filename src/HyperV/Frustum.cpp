@@ -0,0 +1,60 @@
+#include "Frustum.hpp"
+
+namespace HyperV {
+
+Frustum::Frustum(const Matrix4f& viewProj)
+{
+	// Each plane is a sum or a difference of the last row of the matrix and another one.
+	for(size_t axis = 0; axis < 3; ++axis) {
+		_planes[axis*2+0] = viewProj.row(3).transpose() + viewProj.row(axis).transpose();
+		_planes[axis*2+1] = viewProj.row(3).transpose() - viewProj.row(axis).transpose();
+	}
+}
+
+bool Frustum::Contains(const Vector3f& point) const
+{
+	for(const Vector4f& plane : _planes)
+		if(plane.head<3>().dot(point) + plane[3] < 0) return false;
+	return true;
+}
+
+bool Frustum::Intersects(const Aabb& box) const
+{
+	if(box.isEmpty()) return false;
+	for(const Vector4f& plane : _planes) {
+		// Corner of the box the farthest along the normal.
+		Vector3f corner;
+		for(size_t n = 0; n < 3; ++n) corner[n] = (plane[n] >= 0) ? box.max()[n] : box.min()[n];
+		if(plane.head<3>().dot(corner) + plane[3] < 0) return false;
+	}
+	return true;
+}
+
+} // namespace HyperV
+
+void HyperV::unitests_frustum()
+{
+	// Orthographic camera seeing the box [-1, 1]^3.
+	Frustum ortho(Matrix4f::Identity());
+	ASSERT_ALWAYS(ortho.Contains(Vector3f(0.5f, -0.5f, 0.9f)), "Point inside must be contained.");
+	ASSERT_ALWAYS(!ortho.Contains(Vector3f(1.5f, 0.0f, 0.0f)), "Point outside must not be contained.");
+	ASSERT_ALWAYS(ortho.Intersects(Aabb(Vector3f(0.5f, 0.5f, 0.5f), Vector3f(3, 3, 3))), "Box across the border must intersect.");
+	ASSERT_ALWAYS(!ortho.Intersects(Aabb(Vector3f(1.5f, -1, -1), Vector3f(3, 1, 1))), "Box beside must not intersect.");
+	ASSERT_ALWAYS(!ortho.Intersects(Aabb()), "Empty box must not intersect.");
+
+	// Perspective camera at the origin, looking toward -z, with a 90 degrees field of view.
+	const float zNear = 0.1f, zFar = 100.0f;
+	Matrix4f proj = Matrix4f::Zero();
+	proj(0, 0) = proj(1, 1) = 1.0f;
+	proj(2, 2) = -(zFar+zNear)/(zFar-zNear);
+	proj(2, 3) = -2.0f*zFar*zNear/(zFar-zNear);
+	proj(3, 2) = -1.0f;
+	Frustum perspective(proj);
+	ASSERT_ALWAYS(perspective.Contains(Vector3f(0, 0, -10)), "Point in front must be contained.");
+	ASSERT_ALWAYS(!perspective.Contains(Vector3f(0, 0, 10)), "Point behind must not be contained.");
+	ASSERT_ALWAYS(!perspective.Contains(Vector3f(0, 0, -200)), "Point beyond far plane must not be contained.");
+	ASSERT_ALWAYS(perspective.Contains(Vector3f(9, 0, -10)) && !perspective.Contains(Vector3f(11, 0, -10)), "Field of view must be 90 degrees.");
+	ASSERT_ALWAYS(perspective.Intersects(Aabb(Vector3f(-1, -1, -20), Vector3f(1, 1, -10))), "Box in front must intersect.");
+	ASSERT_ALWAYS(!perspective.Intersects(Aabb(Vector3f(-1, -1, 5), Vector3f(1, 1, 10))), "Box behind must not intersect.");
+	ASSERT_ALWAYS(!perspective.Intersects(Aabb(Vector3f(20, -1, -10), Vector3f(30, 1, -5))), "Box aside must not intersect.");
+}
\ No newline at end of file
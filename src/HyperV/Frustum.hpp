@@ -0,0 +1,41 @@
+/**
+ * \author Asso Corentin
+ * \Date May 16 2021
+ * \Desc View frustum, to cull what the camera can't see.
+ */
+#pragma once
+
+#include <array>
+
+#include "Util.hpp"
+
+namespace HyperV {
+
+/**
+ * View frustum of a camera, as six planes extracted from its
+ * view-projection matrix, with normals pointing inside.
+ * Used to hide mesh sections out of view.
+ */
+class Frustum {
+private:
+	/** Planes (a, b, c, d), a point p is inside when a*px + b*py + c*pz + d >= 0. */
+	std::array<Vector4f, 6> _planes;
+
+public:
+	/** Frustum of an OpenGL view-projection matrix, (clip space z in [-w, w]). */
+	explicit Frustum(const Matrix4f& viewProj);
+
+	/** Say if a point is inside. */
+	bool Contains(const Vector3f& point) const;
+
+	/**
+	 * Say if a box is at least partly inside. Some boxes outside, near
+	 * the edges of the frustum, are said inside, never the opposite.
+	 */
+	bool Intersects(const Aabb& box) const;
+};
+
+/** Unit test for Frustum class. */
+void unitests_frustum();
+
+} // namespace HyperV
\ No newline at end of file
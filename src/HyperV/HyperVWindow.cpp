@@ -1,4 +1,5 @@
 #include "HyperVWindow.hpp"
+#include "PackedMeshRender.hpp"
 
 #include <Engine/Rendering/ForwardRenderer.hpp>
 #include <Gui/SelectionManager/SelectionManager.hpp>
@@ -11,6 +12,8 @@
 #include <Engine/Scene/EntityManager.hpp>
 #include <Engine/Scene/GeometryComponent.hpp>
 #include <Engine/Scene/GeometrySystem.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+#include <Engine/Rendering/RenderObjectManager.hpp>
 
 #include <QTimer>
 
@@ -22,36 +25,70 @@ namespace HyperV {
 using IndexVoxelSet = uint8;
 using GameVoxelSet = VoxelSet<IndexVoxelSet>;
 using GameChunk = Chunk32<IndexVoxelSet>;
+using GamePipeline = ChunkPipeline<GameChunk, PackedMeshBuilder>;
 
 /** Game's object. */
-GameChunk chunk(16);
 GameVoxelSet voxelSet = GameVoxelSet::GenDefaultSet();
-Vector3f offset(0.0f, 0.0f, 0.0f);
 
-/** Will generate default terrain. */
+/** Chunks streamed around the camera : 3 chunks of view radius, 256 loaded at most, 32 kept for reuse, 8 loaded per frame, stored in huge pages. */
+ChunkManager<GameChunk> chunks(16, 3, 256, 32, 8, true);
+
+/**
+ * Destroyed before the chunks, so jobs in flight are done. Sections are kept packed between remeshes, and uploaded
+ * packed, culled against the loaded neighbors, meshed again once a chunk next to them is generated or edited.
+ */
+GamePipeline pipeline(voxelSet, chunks.GetTerrain());
+
+/** Entity of a loaded chunk already meshed, with a component for each section holding faces. */
+struct ChunkRender {
+    Ra::Engine::Scene::Entity* entity = nullptr;
+    std::array<Ra::Engine::Scene::Component*, GameChunk::N_BRICKS> sections{};
+    std::array<Aabb, GameChunk::N_BRICKS> boxes;
+};
+std::unordered_map<GameChunk*, ChunkRender> chunkRenders;
+
+/** Parameters of the default terrain. */
+const float terrainSeed = 7;
+const float terrainScale = 0.0625f*3;
+const float levelMin = 4;
+const float levelMax = 6;
+
+/** Ground level of the default terrain, once per column. */
+float DefaultTerrainColumn(
+    const GameChunk& chunk,
+    const Ra::Core::Vector3f worldPos,
+    const typename GameChunk::VoxelArray::Coordinates& coords)
+{
+    const float topography = levelMax-levelMin;
+    float perlin2D = Procedural::PerlinNoise<2>(Vector2f(worldPos[0], worldPos[2]), Vector2f(terrainScale, terrainScale), terrainSeed);
+    return perlin2D*topography+levelMin;
+}
+
+/** Cave noise of the default terrain, smooth enough to be sampled every 4 voxels. */
+float DefaultTerrainCaves(const Ra::Core::Vector3f worldPos)
+{
+    return Procedural::PerlinNoise<3>(worldPos, Vector3f(terrainScale, terrainScale, terrainScale), terrainSeed);
+}
+
+/** Will generate default terrain, from caves sampled over the chunk. */
 IndexVoxelSet DefaultTerrainGen(
     const GameChunk& chunk,
     const Ra::Core::Vector3f worldPos,
     const typename GameChunk::VoxelArray::Coordinates& coords,
-    const IndexVoxelSet previousVoxelID)
+    const IndexVoxelSet previousVoxelID,
+    const float groundLevel,
+    const GameChunk::CoarseArray<4>& caves)
 {
-    const float seed = 7;
     const float threshold = 0.75f;
-    const float scale = 0.0625f*3;
-    const float levelMin = 4;
-    const float levelMax = 6;
-    const float topography = levelMax-levelMin;
 
     if(worldPos[1] < levelMax) {
         // Bellow highest mountaines
-        float perlin2D = Procedural::PerlinNoise<2>(Vector2f(worldPos[0], worldPos[2]), Vector2f(scale, scale), seed);
-        float groundLevel = perlin2D*topography+levelMin;
         if(worldPos[1] > groundLevel) {
             // Above ground
             return 0;
         } else {
             // Bellow ground
-            float perlin3D = Procedural::PerlinNoise<3>(worldPos, Vector3f(scale, scale, scale), seed);
+            float perlin3D = GameChunk::InterpolateCoarse<4>(caves, coords);
             if(perlin3D < threshold) {
                 // Solid ground
                 float distSurface = groundLevel-worldPos[1];
@@ -79,6 +116,22 @@ IndexVoxelSet DefaultTerrainGen(
     }
 }
 
+/** Generate default terrain inside a chunk, each chunk sample its own caves. */
+void DefaultTerrain(GameChunk& chunk)
+{
+    GameChunk::CoarseArray<4> caves;
+    chunk.SampleCoarse<4>(caves, DefaultTerrainCaves, ThreadPool::GetGlobal());
+    chunk.Procedural(
+        DefaultTerrainColumn,
+        [&caves](const GameChunk& chunk, const Ra::Core::Vector3f worldPos,
+            const typename GameChunk::VoxelArray::Coordinates& coords,
+            const IndexVoxelSet previousVoxelID, const float groundLevel) {
+            return DefaultTerrainGen(chunk, worldPos, coords, previousVoxelID, groundLevel, caves);
+        },
+        ThreadPool::GetGlobal()
+    );
+}
+
 /** Generate tree at given coordinate. */
 void GenTreeAt(
     GameChunk& chunk,
@@ -129,7 +182,6 @@ HyperVWindow::HyperVWindow( uint w, uint h, QWidget* parent ) : Ra::Gui::SimpleW
 
 	// Generate terrain
 	//chunk.DrawLine(Vector3f(), Vector3f(0.0f, 16.0f, 0.0f), 1, 3);
-	chunk.Procedural(DefaultTerrainGen);
 	/*GenTreeAt(
 		chunk,
 		Vector3f(0.0f, 0.0f, 0.0f),
@@ -138,27 +190,66 @@ HyperVWindow::HyperVWindow( uint w, uint h, QWidget* parent ) : Ra::Gui::SimpleW
 		7, // Tree's log id
 		6  // Tree's leaf id
 	);*/
-    // Generate chunk's entity and model
-    TriangleMesh chunkMesh = chunk.CubicMesh(voxelSet);
-    auto e = engine->getEntityManager()->createEntity("Chunk");
-    auto c = new Ra::Engine::Scene::TriangleMeshComponent("Chunk Mesh", e, std::move(chunkMesh), nullptr);
-    geometrySystem->addComponent(e, c);
 
+    // Colors of the voxels, looked up by the shaders of the packed sections
+    auto palette = std::make_shared<PackedPalette>(voxelSet);
 
     // Setting up game loop :
-    auto close_timer = new QTimer();
-    close_timer->setInterval(500);
-    QObject::connect(close_timer, &QTimer::timeout, [&chunk](){
-    	// Move chunk offset
-    	offset += Vector3f(0.1f, 0.0f, 0.1f);
-    	//std::cout << offset[0] << ":" << offset[1] << ":" << offset[2] << std::endl;
+    auto game_timer = new QTimer();
+    game_timer->setInterval(16);
+    QObject::connect(game_timer, &QTimer::timeout, [this, engine, geometrySystem, palette](){
+    	// Stream chunks around the camera, they are generated and meshed on workers
+    	const Vector3f eye = getViewer()->getCameraManipulator()->getCamera()->getPosition();
+    	chunks.Update(
+    		eye,
+    		[](GameChunk& chunk) { pipeline.Request(chunk, DefaultTerrain); },
+    		[engine](GameChunk& chunk) {
+    			if(pipeline.IsBusy(chunk)) return false;
+    			pipeline.Forget(chunk);
+    			auto it = chunkRenders.find(&chunk);
+    			if(it != chunkRenders.end()) {
+    				engine->getEntityManager()->removeEntity(it->second.entity);
+    				chunkRenders.erase(it);
+    			}
+    			return true;
+    		}
+    	);
+
+    	// Upload sections changed by the pipeline, without waiting on workers, still packed
+    	pipeline.Poll([engine, geometrySystem, palette](GameChunk& chunk, std::vector<GamePipeline::Section>&& sections) {
+    		ChunkRender& render = chunkRenders[&chunk];
+    		if(render.entity == nullptr) {
+    			const auto& g = chunk.GetGridCoords();
+    			render.entity = engine->getEntityManager()->createEntity(
+    				"Chunk " + std::to_string(g[0]) + " " + std::to_string(g[1]) + " " + std::to_string(g[2]));
+    		}
+    		for(auto& section : sections) {
+    			const std::string name = "Section " + std::to_string(section.index);
+    			if(render.sections[section.index] != nullptr) render.entity->removeComponent(name);
+    			render.sections[section.index] = nullptr;
+    			if(section.mesh.GetQuadCount() == 0) continue;
 
-    	// Generate terrain for chunk
-    	//chunk.Procedural(DefaultTerrainGen);
+    			auto c = new PackedMeshComponent(name, render.entity, std::move(section.mesh), section.box, palette);
+    			geometrySystem->addComponent(render.entity, c);
+    			render.sections[section.index] = c;
+    			render.boxes[section.index] = section.box;
+    		}
+    	});
 
-    	// Recreate mesh for chunk
+    	// Hide sections out of the view frustum
+    	const auto camera = getViewer()->getCameraManipulator()->getCamera();
+    	const Frustum frustum(camera->getProjMatrix() * camera->getViewMatrix().matrix());
+    	auto renderObjects = engine->getRenderObjectManager();
+    	for(auto& [chunk, render] : chunkRenders) {
+    		for(size_t s = 0; s < GameChunk::N_BRICKS; ++s) {
+    			if(render.sections[s] == nullptr) continue;
+    			const bool visible = frustum.Intersects(render.boxes[s]);
+    			for(const auto& ro : render.sections[s]->getRenderObjects())
+    				renderObjects->getRenderObject(ro)->setVisible(visible);
+    		}
+    	}
     });
-    close_timer->start();
+    game_timer->start();
 }
 
 HyperVWindow::~HyperVWindow() = default;
@@ -11,7 +11,11 @@
 #include <Gui/RadiumWindow/SimpleWindow.hpp>
 
 #include "Chunk.hpp"
+#include "Terrain.hpp"
 #include "Procedural.hpp"
+#include "ChunkPipeline.hpp"
+#include "ChunkManager.hpp"
+#include "Frustum.hpp"
 
 namespace HyperV {
 
@@ -0,0 +1,126 @@
+/**
+ * \author Asso Corentin
+ * \Date May 19 2021
+ * \Desc SIMD lanes of 32 bits integers and floats.
+ */
+#pragma once
+
+#include "Util.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace HyperV {
+
+/**
+ * WIDTH lanes of 32 bits, on the widest registers the target has :
+ * AVX-512, AVX2, SSE2 (SSE4.1 when there is), else a single scalar lane.
+ * Integer operations wrap as uint32 ones, float operations are the IEEE
+ * ones, so each lane give the same bits as the scalar code.
+ * Floor and ToInt expect values inside the range of int32.
+ */
+struct Lanes {
+#if defined(__AVX512F__)
+	static constexpr size_t WIDTH = 16;
+	using Int = __m512i;
+	using Float = __m512;
+
+	static inline Int Set(uint32 x) { return _mm512_set1_epi32((int)x); }
+	static inline Int Add(Int a, Int b) { return _mm512_add_epi32(a, b); }
+	static inline Int Mul(Int a, Int b) { return _mm512_mullo_epi32(a, b); }
+	static inline Int Or(Int a, Int b) { return _mm512_or_si512(a, b); }
+	static inline Int Xor(Int a, Int b) { return _mm512_xor_si512(a, b); }
+	template<int R> static inline Int ShiftLeft(Int a) { return _mm512_slli_epi32(a, R); }
+	template<int R> static inline Int ShiftRight(Int a) { return _mm512_srli_epi32(a, R); }
+	static inline void Store(uint32* p, Int a) { _mm512_storeu_si512((void*)p, a); }
+
+	static inline Float Load(const float* p) { return _mm512_loadu_ps(p); }
+	static inline void Store(float* p, Float a) { _mm512_storeu_ps(p, a); }
+	static inline Float Sub(Float a, Float b) { return _mm512_sub_ps(a, b); }
+	static inline Float Floor(Float a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+	static inline Int ToInt(Float a) { return _mm512_cvttps_epi32(a); }
+#elif defined(__AVX2__)
+	static constexpr size_t WIDTH = 8;
+	using Int = __m256i;
+	using Float = __m256;
+
+	static inline Int Set(uint32 x) { return _mm256_set1_epi32((int)x); }
+	static inline Int Add(Int a, Int b) { return _mm256_add_epi32(a, b); }
+	static inline Int Mul(Int a, Int b) { return _mm256_mullo_epi32(a, b); }
+	static inline Int Or(Int a, Int b) { return _mm256_or_si256(a, b); }
+	static inline Int Xor(Int a, Int b) { return _mm256_xor_si256(a, b); }
+	template<int R> static inline Int ShiftLeft(Int a) { return _mm256_slli_epi32(a, R); }
+	template<int R> static inline Int ShiftRight(Int a) { return _mm256_srli_epi32(a, R); }
+	static inline void Store(uint32* p, Int a) { _mm256_storeu_si256((Int*)p, a); }
+
+	static inline Float Load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void Store(float* p, Float a) { _mm256_storeu_ps(p, a); }
+	static inline Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+	static inline Float Floor(Float a) { return _mm256_floor_ps(a); }
+	static inline Int ToInt(Float a) { return _mm256_cvttps_epi32(a); }
+#elif defined(__SSE2__) || defined(_M_X64)
+	static constexpr size_t WIDTH = 4;
+	using Int = __m128i;
+	using Float = __m128;
+
+	static inline Int Set(uint32 x) { return _mm_set1_epi32((int)x); }
+	static inline Int Add(Int a, Int b) { return _mm_add_epi32(a, b); }
+	static inline Int Or(Int a, Int b) { return _mm_or_si128(a, b); }
+	static inline Int Xor(Int a, Int b) { return _mm_xor_si128(a, b); }
+	template<int R> static inline Int ShiftLeft(Int a) { return _mm_slli_epi32(a, R); }
+	template<int R> static inline Int ShiftRight(Int a) { return _mm_srli_epi32(a, R); }
+	static inline void Store(uint32* p, Int a) { _mm_storeu_si128((Int*)p, a); }
+
+	static inline Int Mul(Int a, Int b)
+	{
+#if defined(__SSE4_1__)
+		return _mm_mullo_epi32(a, b);
+#else
+		// Low halves of the products of even lanes, then of odd lanes, interleaved back.
+		const Int even = _mm_mul_epu32(a, b);
+		const Int odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+	}
+
+	static inline Float Load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void Store(float* p, Float a) { _mm_storeu_ps(p, a); }
+	static inline Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+	static inline Int ToInt(Float a) { return _mm_cvttps_epi32(a); }
+
+	static inline Float Floor(Float a)
+	{
+#if defined(__SSE4_1__)
+		return _mm_floor_ps(a);
+#else
+		// Truncate, then step down negative values that weren't integers.
+		const Float truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+		return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+#endif
+	}
+#else
+	static constexpr size_t WIDTH = 1;
+	using Int = uint32;
+	using Float = float;
+
+	static inline Int Set(uint32 x) { return x; }
+	static inline Int Add(Int a, Int b) { return a + b; }
+	static inline Int Mul(Int a, Int b) { return a * b; }
+	static inline Int Or(Int a, Int b) { return a | b; }
+	static inline Int Xor(Int a, Int b) { return a ^ b; }
+	template<int R> static inline Int ShiftLeft(Int a) { return a << R; }
+	template<int R> static inline Int ShiftRight(Int a) { return a >> R; }
+	static inline void Store(uint32* p, Int a) { *p = a; }
+
+	static inline Float Load(const float* p) { return *p; }
+	static inline void Store(float* p, Float a) { *p = a; }
+	static inline Float Sub(Float a, Float b) { return a - b; }
+	static inline Float Floor(Float a) { return std::floor(a); }
+	static inline Int ToInt(Float a) { return (uint32)(int)a; }
+#endif
+
+	template<int R> static inline Int Rotl(Int a) { return Or(ShiftLeft<R>(a), ShiftRight<32-R>(a)); }
+};
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,40 @@
+#include "MeshBuilder.hpp"
+
+namespace HyperV {
+
+void MeshBuilder::Append(const MeshBuilder& other)
+{
+	const uint32 first = _vertices.size();
+	_vertices.insert(_vertices.end(), other._vertices.begin(), other._vertices.end());
+	_normals.insert(_normals.end(), other._normals.begin(), other._normals.end());
+	_colors.insert(_colors.end(), other._colors.begin(), other._colors.end());
+	_indices.reserve(_indices.size() + other._indices.size());
+	for(const auto& triangle : other._indices)
+		_indices.emplace_back(triangle[0]+first, triangle[1]+first, triangle[2]+first);
+}
+
+TriangleMesh MeshBuilder::ToTriangleMesh()
+{
+	TriangleMesh mesh;
+	mesh.setVertices(std::move(_vertices));
+	mesh.setNormals(std::move(_normals));
+	mesh.setIndices(std::move(_indices));
+	mesh.addAttrib(COLOR_ATTRIB, std::move(_colors));
+	mesh.checkConsistency();
+	Clear();
+	return mesh;
+}
+
+std::string PackedMeshBuilder::GlslDecode()
+{
+	const std::string mask = std::to_string(COORD_MASK) + "u";
+	const std::string bits = std::to_string(COORD_BITS) + "u";
+	return
+		"uniform vec3 chunkOrigin;\n"
+		"uniform float voxelSize;\n"
+		"vec3 VoxelPosition(uint v) { return chunkOrigin + voxelSize*vec3(uvec3(v, v >> " + bits + ", v >> (2u*" + bits + ")) & " + mask + "); }\n"
+		"vec3 VoxelNormal(uint v) { uint face = (v >> " + std::to_string(FACE_SHIFT) + "u) & 7u; vec3 n = vec3(0.0); n[face >> 1u] = ((face & 1u) == 0u) ? 1.0 : -1.0; return n; }\n"
+		"uint VoxelID(uint v) { return v >> " + std::to_string(ID_SHIFT) + "u; }\n";
+}
+
+} // namespace HyperV
\ No newline at end of file
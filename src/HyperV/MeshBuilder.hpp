@@ -0,0 +1,366 @@
+/**
+ * \author Asso Corentin
+ * \Date May 6 2021
+ * \Desc Flat buffers to build voxel meshes.
+ */
+#pragma once
+
+#include <Core/Types.hpp>
+#include <Core/Geometry/TriangleMesh.hpp>
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Util.hpp"
+
+namespace HyperV {
+
+/**
+ * Build a mesh made of quads straight into flat arrays.
+ * Capacity is reserved once, with the number of faces known in advance,
+ * then the arrays are moved inside a TriangleMesh at the end, instead of
+ * building and appending a TriangleMesh for each face.
+ */
+class MeshBuilder {
+public:
+	/** Name of the color attribute read by the shaders. */
+	static constexpr const char* COLOR_ATTRIB = "in_color";
+
+private:
+	Ra::Core::Vector3Array _vertices;
+	Ra::Core::Vector3Array _normals;
+	Ra::Core::Vector4Array _colors;
+	Ra::Core::Vector3uiArray _indices;
+
+public:
+	/** Reserve memory for given number of quads. */
+	inline void Reserve(size_t nQuads)
+	{
+		_vertices.reserve(_vertices.size() + nQuads*4);
+		_normals.reserve(_normals.size() + nQuads*4);
+		_colors.reserve(_colors.size() + nQuads*4);
+		_indices.reserve(_indices.size() + nQuads*2);
+	}
+
+	/**
+	 * Add a quad, corners must be given counter clockwise
+	 * when seen from the normal.
+	 */
+	inline void AddQuad(
+		const Vector3f& p0, const Vector3f& p1, const Vector3f& p2, const Vector3f& p3,
+		const Vector3f& normal,
+		const Ra::Core::Vector4& color)
+	{
+		const uint32 first = _vertices.size();
+		_vertices.push_back(p0);
+		_vertices.push_back(p1);
+		_vertices.push_back(p2);
+		_vertices.push_back(p3);
+		for(size_t i = 0; i < 4; ++i) {
+			_normals.push_back(normal);
+			_colors.push_back(color);
+		}
+		_indices.emplace_back(first+0, first+1, first+2);
+		_indices.emplace_back(first+0, first+2, first+3);
+	}
+
+	/** Number of quads added. */
+	inline size_t GetQuadCount() const { return _indices.size()/2; }
+
+	/** Bounding box of the quads added, empty if there is none. */
+	inline Aabb GetBox() const
+	{
+		Aabb box;
+		box.setEmpty();
+		for(const auto& vertex : _vertices) box.extend(vertex);
+		return box;
+	}
+
+	/** Remove all quads, but keep memory. */
+	inline void Clear()
+	{
+		_vertices.clear();
+		_normals.clear();
+		_colors.clear();
+		_indices.clear();
+	}
+
+	/** Memory used by the buffers, in bytes. */
+	inline size_t GetMemoryUsage() const
+	{
+		return _vertices.capacity()*sizeof(_vertices[0]) + _normals.capacity()*sizeof(_normals[0])
+			+ _colors.capacity()*sizeof(_colors[0]) + _indices.capacity()*sizeof(_indices[0]);
+	}
+
+	/** Add the quads of another builder. */
+	void Append(const MeshBuilder& other);
+
+	/** Move the buffers inside a mesh, the builder is left empty. */
+	TriangleMesh ToTriangleMesh();
+};
+
+/**
+ * Build a mesh made of quads, each vertex packed on 32 bits : its position
+ * on the lattice of the corners of the voxels, the face it belong to,
+ * (E_NEIGHBOR order), and the ID of its voxel, which give its color in
+ * the palette of the VoxelSet. Indices are implicit, quad q is made of
+ * vertices 4q to 4q+3, so a quad take 16 bytes, against 184 with
+ * MeshBuilder.
+ * Lattice positions are relative to the origin of the chunk, its corner
+ * of lowest coordinates, which is given with the voxel size to shaders
+ * as uniforms, so packed vertices are uploaded as they are.
+ */
+class PackedMeshBuilder {
+public:
+	/** Bits of each lattice coordinate, for chunks up to 127 voxels wide. */
+	static constexpr uint32 COORD_BITS = 7;
+	static constexpr uint32 COORD_MASK = (1u << COORD_BITS) - 1;
+
+	/** First bit of the face, then of the voxel ID, stored on the last 8 bits. */
+	static constexpr uint32 FACE_SHIFT = 3*COORD_BITS;
+	static constexpr uint32 ID_SHIFT = FACE_SHIFT + 3;
+
+	/**
+	 * Decoding of packed vertices for vertex shaders, declaring the uniforms
+	 * chunkOrigin and voxelSize, and VoxelPosition, VoxelNormal and VoxelID.
+	 */
+	static std::string GlslDecode();
+
+	using Lattice = std::array<uint32, 3>;
+
+	/** Pack a vertex. */
+	static inline uint32 Pack(const Lattice& lattice, uint32 face, uint32 voxelID)
+	{
+		ASSERT_PARANOID(lattice[0] <= COORD_MASK && lattice[1] <= COORD_MASK && lattice[2] <= COORD_MASK, "Lattice position doesn't fit.");
+		ASSERT_PARANOID(face < 6 && voxelID < 256, "Face or voxel ID doesn't fit.");
+		return lattice[0] | (lattice[1] << COORD_BITS) | (lattice[2] << 2*COORD_BITS) | (face << FACE_SHIFT) | (voxelID << ID_SHIFT);
+	}
+
+	static inline Lattice UnpackLattice(uint32 vertex)
+	{
+		return {vertex & COORD_MASK, (vertex >> COORD_BITS) & COORD_MASK, (vertex >> 2*COORD_BITS) & COORD_MASK};
+	}
+
+	static inline uint32 UnpackFace(uint32 vertex) { return (vertex >> FACE_SHIFT) & 0b111; }
+
+	static inline uint32 UnpackVoxelID(uint32 vertex) { return vertex >> ID_SHIFT; }
+
+	static inline Vector3f UnpackNormal(uint32 vertex)
+	{
+		const uint32 face = UnpackFace(vertex);
+		Vector3f normal(0, 0, 0);
+		normal[face >> 1] = (face & 1) ? -1.0f : 1.0f;
+		return normal;
+	}
+
+private:
+	std::vector<uint32> _vertices;
+
+	/** World position of the lattice's origin. */
+	Vector3f _origin = Vector3f::Zero();
+
+	/** World size of a step on the lattice. */
+	float _voxelSize = 1.0f;
+
+public:
+	/** Set the world position of the lattice's origin, and the size of a step. */
+	inline void SetFrame(const Vector3f& origin, float voxelSize)
+	{
+		_origin = origin;
+		_voxelSize = voxelSize;
+	}
+
+	inline const Vector3f& GetOrigin() const { return _origin; }
+	inline float GetVoxelSize() const { return _voxelSize; }
+
+	/** World position of a vertex. */
+	inline Vector3f UnpackPosition(uint32 vertex) const
+	{
+		const Lattice lattice = UnpackLattice(vertex);
+		return _origin + _voxelSize*Vector3f(lattice[0], lattice[1], lattice[2]);
+	}
+
+	/** Reserve memory for given number of quads. */
+	inline void Reserve(size_t nQuads) { _vertices.reserve(_vertices.size() + nQuads*4); }
+
+	/**
+	 * Add a quad, corners must be given counter clockwise
+	 * when seen from the normal.
+	 */
+	inline void AddQuad(const Lattice& c0, const Lattice& c1, const Lattice& c2, const Lattice& c3, uint32 face, uint32 voxelID)
+	{
+		_vertices.push_back(Pack(c0, face, voxelID));
+		_vertices.push_back(Pack(c1, face, voxelID));
+		_vertices.push_back(Pack(c2, face, voxelID));
+		_vertices.push_back(Pack(c3, face, voxelID));
+	}
+
+	/** Number of quads added. */
+	inline size_t GetQuadCount() const { return _vertices.size()/4; }
+
+	/** Packed vertices, 4 per quad. */
+	inline const std::vector<uint32>& GetVertices() const { return _vertices; }
+
+	/** Remove all quads, but keep memory and frame. */
+	inline void Clear() { _vertices.clear(); }
+
+	/** Memory used by the buffer, in bytes. */
+	inline size_t GetMemoryUsage() const { return _vertices.capacity()*sizeof(uint32); }
+
+	/** Add the quads of another builder, with the same frame. */
+	inline void Append(const PackedMeshBuilder& other)
+	{
+		if(_vertices.empty()) SetFrame(other._origin, other._voxelSize);
+		ASSERT(other._vertices.empty() || (_origin == other._origin && _voxelSize == other._voxelSize), "Appending quads of another frame.");
+		_vertices.insert(_vertices.end(), other._vertices.begin(), other._vertices.end());
+	}
+
+	/** Bounding box of the quads added, empty if there is none. */
+	inline Aabb GetBox() const
+	{
+		Aabb box;
+		box.setEmpty();
+		for(uint32 vertex : _vertices) box.extend(UnpackPosition(vertex));
+		return box;
+	}
+
+	/** Unpack into a mesh, colorOf(voxelID) give the color of a voxel. */
+	template<typename F>
+	TriangleMesh ToTriangleMesh(F colorOf) const
+	{
+		MeshBuilder mesh;
+		mesh.Reserve(GetQuadCount());
+		for(size_t v = 0; v < _vertices.size(); v += 4) {
+			const uint32 first = _vertices[v];
+			mesh.AddQuad(
+				UnpackPosition(first), UnpackPosition(_vertices[v+1]), UnpackPosition(_vertices[v+2]), UnpackPosition(_vertices[v+3]),
+				UnpackNormal(first), colorOf(UnpackVoxelID(first))
+			);
+		}
+		return mesh.ToTriangleMesh();
+	}
+};
+
+/**
+ * Mesh split into sections, each with its own buffers, so a section is
+ * rebuilt without touching the others, then sections are spliced into a
+ * single mesh.
+ * Each section remember the generation of the voxels it was built from,
+ * it is stale once they are edited again, and its bounding box, to be
+ * culled on its own. Sections rebuilt are recorded as changed, until
+ * they are taken to be uploaded.
+ */
+template<typename BUILDER>
+class BasicSectionedMesh {
+public:
+	/** Generation of a section never built. */
+	static constexpr uint64 NEVER_BUILT = std::numeric_limits<uint64>::max();
+
+private:
+	std::vector<BUILDER> _sections;
+	std::vector<uint64> _generations;
+	std::vector<Aabb> _boxes;
+	std::vector<bool> _changed;
+
+public:
+	/** Set the number of sections, they all have to be built again, and are changed. */
+	inline void Resize(size_t nSections)
+	{
+		Aabb empty;
+		empty.setEmpty();
+		_sections.assign(nSections, BUILDER());
+		_generations.assign(nSections, NEVER_BUILT);
+		_boxes.assign(nSections, empty);
+		_changed.assign(nSections, true);
+	}
+
+	/** Number of sections. */
+	inline size_t GetSectionCount() const { return _sections.size(); }
+
+	/** Say if a section must be rebuilt, given the generation of the last edit of its voxels. */
+	inline bool IsStale(size_t section, uint64 generation) const
+	{
+		return _generations[section] == NEVER_BUILT || generation > _generations[section];
+	}
+
+	/** Generation of the voxels a section was built from. */
+	inline uint64 GetGeneration(size_t section) const { return _generations[section]; }
+
+	/** Empty a section to build it again, its memory is kept. */
+	inline BUILDER& BeginSection(size_t section)
+	{
+		_sections[section].Clear();
+		_generations[section] = NEVER_BUILT;
+		return _sections[section];
+	}
+
+	/** Mark a section as built from voxels of given generation, and changed. */
+	inline void EndSection(size_t section, uint64 generation)
+	{
+		_generations[section] = generation;
+		_boxes[section] = _sections[section].GetBox();
+		_changed[section] = true;
+	}
+
+	/** Bounding box of a section, empty if it has no quads. */
+	inline const Aabb& GetBox(size_t section) const { return _boxes[section]; }
+
+	/** Sections changed since the last call. */
+	inline std::vector<size_t> TakeChanged()
+	{
+		std::vector<size_t> changed;
+		for(size_t section = 0; section < _changed.size(); ++section) {
+			if(!_changed[section]) continue;
+			changed.push_back(section);
+			_changed[section] = false;
+		}
+		return changed;
+	}
+
+	/** Quads of a section. */
+	inline const BUILDER& GetSection(size_t section) const { return _sections[section]; }
+
+	/** Number of quads of every section. */
+	inline size_t GetQuadCount() const
+	{
+		size_t nQuads = 0;
+		for(const BUILDER& section : _sections) nQuads += section.GetQuadCount();
+		return nQuads;
+	}
+
+	/** Memory used by every section, in bytes. */
+	inline size_t GetMemoryUsage() const
+	{
+		size_t bytes = 0;
+		for(const BUILDER& section : _sections) bytes += section.GetMemoryUsage();
+		return bytes;
+	}
+
+	/** Copy a section into a mesh of its own, args are given to the ToTriangleMesh of the builder. */
+	template<typename... Args>
+	TriangleMesh SectionToTriangleMesh(size_t section, const Args&... args) const
+	{
+		BUILDER mesh(_sections[section]);
+		return mesh.ToTriangleMesh(args...);
+	}
+
+	/** Splice every section into a single mesh, sections are kept. */
+	template<typename... Args>
+	TriangleMesh ToTriangleMesh(const Args&... args) const
+	{
+		BUILDER mesh;
+		mesh.Reserve(GetQuadCount());
+		for(const BUILDER& section : _sections) mesh.Append(section);
+		return mesh.ToTriangleMesh(args...);
+	}
+};
+
+/** Sections of plain vertices, ready to be uploaded. */
+using SectionedMesh = BasicSectionedMesh<MeshBuilder>;
+
+/** Sections of packed vertices, 11 times smaller to keep. */
+using PackedSectionedMesh = BasicSectionedMesh<PackedMeshBuilder>;
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "PackedMeshRender.hpp"
+
+#include <Engine/Data/ShaderConfigFactory.hpp>
+#include <Engine/Data/ShaderConfiguration.hpp>
+#include <Engine/Data/ShaderProgram.hpp>
+#include <Engine/Rendering/RenderObject.hpp>
+
+#include <glbinding/gl/enum.h>
+#include <globjects/Buffer.h>
+#include <globjects/Texture.h>
+#include <globjects/VertexArray.h>
+
+namespace HyperV {
+
+namespace {
+
+/** Fetch the corners of the two triangles of each quad, the ones of MeshBuilder, and decode them. */
+const char* VERTEX_SHADER = R"(
+struct Transform { mat4 model; mat4 view; mat4 proj; mat4 worldNormal; };
+uniform Transform transform;
+uniform usamplerBuffer packedVertices;
+uniform samplerBuffer palette;
+
+out vec3 v_normal;
+out vec4 v_color;
+
+const int CORNERS[6] = int[6](0, 1, 2, 0, 2, 3);
+
+void main()
+{
+	uint v = texelFetch(packedVertices, (gl_VertexID/6)*4 + CORNERS[gl_VertexID%6]).r;
+	v_normal = normalize(mat3(transform.worldNormal) * VoxelNormal(v));
+	v_color = texelFetch(palette, int(VoxelID(v)));
+	gl_Position = transform.proj * transform.view * transform.model * vec4(VoxelPosition(v), 1.0);
+}
+)";
+
+/** Depth, ambient and normal of the prepass of the forward renderer. */
+const char* PREPASS_SHADER = R"(
+in vec3 v_normal;
+in vec4 v_color;
+
+layout (location = 0) out vec4 out_ambient;
+layout (location = 1) out vec4 out_normal;
+
+void main()
+{
+	out_ambient = vec4(v_color.rgb*0.1, 1.0);
+	out_normal = vec4(v_normal*0.5 + 0.5, 1.0);
+}
+)";
+
+/** Faces are lit by a fixed sun, the voxels have no material. */
+const char* LIGHTING_SHADER = R"(
+in vec3 v_normal;
+in vec4 v_color;
+
+layout (location = 0) out vec4 out_color;
+
+const vec3 SUN = normalize(vec3(0.3, 1.0, 0.5));
+
+void main()
+{
+	out_color = vec4(v_color.rgb*(0.35 + 0.65*max(dot(v_normal, SUN), 0.0)), 1.0);
+}
+)";
+
+} // namespace
+
+PackedPalette::~PackedPalette() = default;
+
+void PackedPalette::Bind(int unit)
+{
+	if(_texture == nullptr) {
+		_buffer = globjects::Buffer::create();
+		_buffer->setData(_colors.size()*sizeof(Ra::Core::Vector4), _colors.data(), gl::GL_STATIC_DRAW);
+		_texture = globjects::Texture::create(gl::GL_TEXTURE_BUFFER);
+		_texture->texBuffer(gl::GL_RGBA32F, _buffer.get());
+	}
+	_texture->bindActive(unit);
+}
+
+PackedMeshDisplayable::PackedMeshDisplayable(const std::string& name, PackedMeshBuilder&& mesh, const Aabb& box, std::shared_ptr<PackedPalette> palette) :
+	Ra::Engine::Data::Displayable(name),
+	_mesh(std::move(mesh)),
+	_origin(_mesh.GetOrigin()),
+	_voxelSize(_mesh.GetVoxelSize()),
+	_nQuads(_mesh.GetQuadCount()),
+	_palette(std::move(palette))
+{
+	Ra::Core::Vector3Array corners;
+	corners.push_back(box.min());
+	corners.push_back(box.max());
+	_bounds.setVertices(std::move(corners));
+}
+
+PackedMeshDisplayable::~PackedMeshDisplayable() = default;
+
+void PackedMeshDisplayable::updateGL()
+{
+	if(_vao != nullptr) return;
+	const std::vector<uint32>& vertices = _mesh.GetVertices();
+	_buffer = globjects::Buffer::create();
+	_buffer->setData(vertices.size()*sizeof(uint32), vertices.data(), gl::GL_STATIC_DRAW);
+	_texture = globjects::Texture::create(gl::GL_TEXTURE_BUFFER);
+	_texture->texBuffer(gl::GL_R32UI, _buffer.get());
+	_vao = globjects::VertexArray::create();
+	_mesh = PackedMeshBuilder();
+}
+
+void PackedMeshDisplayable::render(const Ra::Engine::Data::ShaderProgram* prog)
+{
+	if(_vao == nullptr) return;
+	_texture->bindActive(0);
+	_palette->Bind(1);
+	prog->setUniform("packedVertices", 0);
+	prog->setUniform("palette", 1);
+	prog->setUniform("chunkOrigin", _origin);
+	prog->setUniform("voxelSize", _voxelSize);
+	_vao->drawArrays(gl::GL_TRIANGLES, 0, (gl::GLsizei)(6*_nQuads));
+}
+
+PackedMeshComponent::PackedMeshComponent(const std::string& name, Ra::Engine::Scene::Entity* entity, PackedMeshBuilder&& mesh, const Aabb& box, std::shared_ptr<PackedPalette> palette) :
+	Ra::Engine::Scene::Component(name, entity)
+{
+	auto displayable = std::make_shared<PackedMeshDisplayable>(name, std::move(mesh), box, std::move(palette));
+	addRenderObject(Ra::Engine::Rendering::RenderObject::createRenderObject(
+		name, this, Ra::Engine::Rendering::RenderObjectType::Geometry, displayable, GetRenderTechnique()));
+}
+
+const Ra::Engine::Rendering::RenderTechnique& PackedMeshComponent::GetRenderTechnique()
+{
+	using namespace Ra::Engine::Data;
+	using namespace Ra::Engine::Rendering;
+	static const RenderTechnique technique = []() {
+		const std::string vertex = PackedMeshBuilder::GlslDecode() + VERTEX_SHADER;
+		ShaderConfiguration prepass("PackedVoxelsZPrepass");
+		prepass.addShaderSource(ShaderType::ShaderType_VERTEX, vertex);
+		prepass.addShaderSource(ShaderType::ShaderType_FRAGMENT, PREPASS_SHADER);
+		ShaderConfigurationFactory::addConfiguration(prepass);
+		ShaderConfiguration lighting("PackedVoxels");
+		lighting.addShaderSource(ShaderType::ShaderType_VERTEX, vertex);
+		lighting.addShaderSource(ShaderType::ShaderType_FRAGMENT, LIGHTING_SHADER);
+		ShaderConfigurationFactory::addConfiguration(lighting);
+
+		RenderTechnique rt;
+		rt.setConfiguration(prepass, DefaultRenderingPasses::Z_PREPASS);
+		rt.setConfiguration(lighting, DefaultRenderingPasses::LIGHTING_OPAQUE);
+		return rt;
+	}();
+	return technique;
+}
+
+} // namespace HyperV
@@ -0,0 +1,98 @@
+/**
+ * \author Asso Corentin
+ * \Date May 21 2021
+ * \Desc Rendering of packed meshes, decoded on the GPU.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Core/Geometry/TriangleMesh.hpp>
+#include <Engine/Data/Displayable.hpp>
+#include <Engine/Rendering/RenderTechnique.hpp>
+#include <Engine/Scene/Component.hpp>
+
+#include "MeshBuilder.hpp"
+#include "VoxelSet.hpp"
+
+namespace globjects {
+class Buffer;
+class Texture;
+class VertexArray;
+} // namespace globjects
+
+namespace HyperV {
+
+/**
+ * Colors of the voxel IDs, in a buffer texture shared by every packed
+ * mesh. Uploaded by the first mesh drawn, on the render thread.
+ */
+class PackedPalette {
+private:
+	std::vector<Ra::Core::Vector4> _colors;
+	std::unique_ptr<globjects::Buffer> _buffer;
+	std::unique_ptr<globjects::Texture> _texture;
+
+public:
+	template<typename VoxelID>
+	explicit PackedPalette(const VoxelSet<VoxelID>& voxelSet)
+	{
+		_colors.reserve(voxelSet.GetSize());
+		for(size_t id = 0; id < voxelSet.GetSize(); ++id) _colors.push_back(voxelSet.Get(id).color);
+	}
+
+	~PackedPalette();
+
+	/** Upload the colors if they aren't, and bind them to given texture unit. */
+	void Bind(int unit);
+};
+
+/**
+ * Packed quads of a section, uploaded as they are into a buffer texture.
+ * The vertex shader fetch the 4 vertices of each quad from gl_VertexID,
+ * so there is no index buffer, and decode them with the frame given as
+ * uniforms. The CPU copy is freed once uploaded.
+ */
+class PackedMeshDisplayable : public Ra::Engine::Data::Displayable {
+private:
+	PackedMeshBuilder _mesh;
+	Vector3f _origin;
+	float _voxelSize;
+	size_t _nQuads;
+	std::shared_ptr<PackedPalette> _palette;
+
+	/** Corners of the bounding box only, for Radium's picking and bounds. */
+	Ra::Core::Geometry::TriangleMesh _bounds;
+
+	std::unique_ptr<globjects::Buffer> _buffer;
+	std::unique_ptr<globjects::Texture> _texture;
+	std::unique_ptr<globjects::VertexArray> _vao;
+
+public:
+	PackedMeshDisplayable(const std::string& name, PackedMeshBuilder&& mesh, const Aabb& box, std::shared_ptr<PackedPalette> palette);
+	~PackedMeshDisplayable() override;
+
+	const Ra::Core::Geometry::AbstractGeometry& getAbstractGeometry() const override { return _bounds; }
+	Ra::Core::Geometry::AbstractGeometry& getAbstractGeometry() override { return _bounds; }
+
+	size_t getNumFaces() const override { return 2*_nQuads; }
+	size_t getNumVertices() const override { return 4*_nQuads; }
+
+	void updateGL() override;
+	void render(const Ra::Engine::Data::ShaderProgram* prog) override;
+};
+
+/** Component drawing a packed section, with the shaders decoding it. */
+class PackedMeshComponent : public Ra::Engine::Scene::Component {
+public:
+	PackedMeshComponent(const std::string& name, Ra::Engine::Scene::Entity* entity, PackedMeshBuilder&& mesh, const Aabb& box, std::shared_ptr<PackedPalette> palette);
+
+	void initialize() override {}
+
+	/** Shaders of the depth prepass and of the lighting pass, registered on first call. */
+	static const Ra::Engine::Rendering::RenderTechnique& GetRenderTechnique();
+};
+
+} // namespace HyperV
@@ -0,0 +1,54 @@
+#include "PaletteArray.hpp"
+#include "Chunk.hpp"
+
+void HyperV::unitests_palette_array()
+{
+	using Array = SPaletteArray<uint8, 16, 16, 16>;
+	Array array;
+	ASSERT_ALWAYS(array.IsUniform() && array.Get(0) == 0, "New palette array must be uniform air.");
+	ASSERT_ALWAYS(array.GetMemoryUsage() < 64, "Uniform palette array must not store elements.");
+
+	// Palette grow, indices are repacked on more bits.
+	const size_t expectedBits[] = {1, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 8};
+	for(uint8 v = 1; v <= 16; ++v) {
+		array.Set(v*100, v);
+		ASSERT_ALWAYS(array.GetBitsPerElement() == expectedBits[v-1], "Wrong number of bits per element.");
+	}
+	for(size_t i = 0; i < Array::SIZE; ++i) {
+		const uint8 expected = (i % 100 == 0 && i/100 >= 1 && i/100 <= 16) ? i/100 : 0;
+		ASSERT_ALWAYS(array[i] == expected, "Repacking must keep every element.");
+	}
+
+	// Write through coordinates, and a proxy.
+	array(Array::CoordsFor(5)) = 42;
+	array[6] = array[5];
+	ASSERT_ALWAYS(array.Get(6) == 42, "Writing through proxy failed.");
+
+	// Removing values then compacting shrink the palette.
+	for(uint8 v = 1; v <= 16; ++v) array.Set(v*100, 0);
+	array.Compact();
+	ASSERT_ALWAYS(array.GetPaletteSize() == 2 && array.GetBitsPerElement() == 1, "Compact must drop unused values.");
+	ASSERT_ALWAYS(array[5] == 42 && array[6] == 42 && array[800] == 0, "Compact must keep every element.");
+	array.Fill(7);
+	ASSERT_ALWAYS(array.IsUniform() && array[1234] == 7, "Fill must make array uniform.");
+
+	// A palette chunk behave as a plain chunk.
+	Chunk16<uint8> plain(16);
+	SparseChunk<16> sparse(16);
+	SparseChunk<16> sparseParallel(16);
+	auto gen = [](const auto&, const VectorNf<3> worldPos, const std::array<size_t, 3>& coords, uint8) -> uint8 {
+		return (worldPos[1] < (float)((coords[0]*3 + coords[2]) % 7)) ? 3 : 0;
+	};
+	ThreadPool pool(3);
+	plain.Procedural(gen);
+	sparse.Procedural(gen);
+	sparseParallel.Procedural(gen, pool);
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords()) {
+		ASSERT_ALWAYS(plain.GetVoxel(coords) == sparse.GetVoxel(coords), "Palette chunk differ from plain chunk.");
+		ASSERT_ALWAYS(plain.GetVoxel(coords) == sparseParallel.GetVoxel(coords), "Parallel palette chunk differ from plain chunk.");
+	}
+	ASSERT_ALWAYS(sparse.GetVoxels().GetBitsPerElement() == 1, "Two voxel kinds must take one bit each.");
+
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+	ASSERT_ALWAYS(plain.GreedyMesh(voxelSet).getIndices().size() == sparse.GreedyMesh(voxelSet).getIndices().size(), "Palette chunk must give the same mesh.");
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+/**
+ * \author Asso Corentin
+ * \Date May 10 2021
+ * \Desc Compressed arrays, with a palette of values.
+ */
+#pragma once
+
+#include <vector>
+
+#include "Array.hpp"
+
+namespace HyperV {
+
+/**
+ * Array of n dimension, storing for each element an index inside a palette
+ * of the distinct values of the array, packed on 1, 2, 4, 8 or 16 bits.
+ * If the array hold a single value, nothing but the palette is stored.
+ * Writing a new value add it to the palette, and repack indices on more
+ * bits if needed.
+ * Layout of the elements (indexing mode) is the same than NArray.
+ * Element are accessed by value, or through a proxy for writing, and
+ * writes must not happen concurrently.
+ */
+template<IndexingMode::Enum INDEXING, typename T, size_t... DIMS>
+class PaletteArray {
+public:
+	/** Dense array with the same layout, used for index calculation. */
+	using Layout = NArray<INDEXING, T, DIMS...>;
+
+	/** Number of elements in the array. */
+	static constexpr size_t SIZE = Layout::SIZE;
+
+	/** Number of dimension for this array. */
+	static constexpr size_t N = Layout::N;
+
+	/** Width of the array on each axis. */
+	static constexpr auto WIDTHS = Layout::WIDTHS;
+
+	/** Writing different elements from different threads is not safe. */
+	static constexpr bool CONCURRENT_WRITES = false;
+
+	using Coordinates = typename Layout::Coordinates;
+
+private:
+	/** Distinct values of the array. */
+	std::vector<T> _palette;
+
+	/** Packed indices inside the palette, empty if the array is uniform. */
+	std::vector<uint64> _words;
+
+	/** Number of bits per index, 0 if the array is uniform. */
+	size_t _bits = 0;
+
+	/** Number of bits of indices needed for a palette of given size. */
+	static inline size_t BitsFor(size_t paletteSize)
+	{
+		if(paletteSize <= 1) return 0;
+		size_t bits = 1;
+		while((((size_t)0b1) << bits) < paletteSize) bits <<= 1;
+		return bits;
+	}
+
+	/** Read index inside the palette of given element, with given number of bits. */
+	static inline size_t ReadIndex(const std::vector<uint64>& words, size_t bits, size_t i)
+	{
+		if(bits == 0) return 0;
+		const size_t perWord = 64/bits;
+		const uint64 mask = (((uint64)0b1) << bits) - 1;
+		return (words[i/perWord] >> ((i%perWord)*bits)) & mask;
+	}
+
+	/** Write index inside the palette of given element. */
+	inline void WriteIndex(size_t i, size_t paletteIndex)
+	{
+		const size_t perWord = 64/_bits;
+		const uint64 mask = (((uint64)0b1) << _bits) - 1;
+		const size_t shift = (i%perWord)*_bits;
+		uint64& word = _words[i/perWord];
+		word = (word & ~(mask << shift)) | (((uint64)paletteIndex) << shift);
+	}
+
+	/** Repack every index on given number of bits. */
+	void Repack(size_t bits)
+	{
+		if(bits == _bits) return;
+		std::vector<uint64> words;
+		if(bits > 0) {
+			const size_t perWord = 64/bits;
+			words.assign((SIZE + perWord-1)/perWord, 0);
+			for(size_t i = 0; i < SIZE; ++i)
+				words[i/perWord] |= ((uint64)ReadIndex(_words, _bits, i)) << ((i%perWord)*bits);
+		}
+		_words = std::move(words);
+		_bits = bits;
+	}
+
+	/** Find value in the palette, add it if needed. */
+	inline size_t PaletteIndexOf(T value)
+	{
+		for(size_t p = 0; p < _palette.size(); ++p)
+			if(_palette[p] == value) return p;
+		_palette.push_back(value);
+		Repack(BitsFor(_palette.size()));
+		return _palette.size()-1;
+	}
+
+public:
+	/** Proxy to write an element of the array. */
+	class Reference {
+	private:
+		PaletteArray& _array;
+		size_t _index;
+
+	public:
+		Reference(PaletteArray& array, size_t index) : _array(array), _index(index) {}
+		inline operator T() const { return _array.Get(_index); }
+		inline Reference& operator= (T value) { _array.Set(_index, value); return *this; }
+		inline Reference& operator= (const Reference& other) { return *this = (T)other; }
+	};
+
+	/** Array filled with T(). */
+	PaletteArray() : _palette(1, T()) {}
+
+	/** Return index at given coordinate. */
+	template<typename... Pack>
+	static inline size_t IndexAt(Pack... coords) { return Layout::IndexAt(coords...); }
+
+	/** Return coordinate for given index. */
+	static inline Coordinates CoordsFor(Coordinates& coords, size_t index) { return Layout::CoordsFor(coords, index); }
+
+	/** Return coordinate for given index. */
+	static inline Coordinates CoordsFor(size_t index) { return Layout::CoordsFor(index); }
+
+	/** Iterate each (index, coordinates) of the array. */
+	static inline auto Coords(size_t first = 0, size_t last = SIZE) { return Layout::Coords(first, last); }
+
+	/** Get width of the array on a given axes at runtime. */
+	static inline size_t WidthOf(size_t axis) { return Layout::WidthOf(axis); }
+
+	/** Get element at given index. */
+	inline T Get(size_t i) const
+	{
+		ASSERT(i < SIZE, "Index out of bound.");
+		return _palette[ReadIndex(_words, _bits, i)];
+	}
+
+	/** Set element at given index. */
+	inline void Set(size_t i, T value)
+	{
+		ASSERT(i < SIZE, "Index out of bound.");
+		if(_bits == 0 && _palette[0] == value) return;
+		const size_t paletteIndex = PaletteIndexOf(value);
+		WriteIndex(i, paletteIndex);
+	}
+
+	/** Set every element to the same value, the array become uniform. */
+	void Fill(T value)
+	{
+		_palette.assign(1, value);
+		_words.clear();
+		_words.shrink_to_fit();
+		_bits = 0;
+	}
+
+	/** Remove unused values from the palette, and repack on fewer bits if possible. */
+	void Compact()
+	{
+		if(_bits == 0) return;
+		std::vector<size_t> remap(_palette.size(), 0);
+		for(size_t i = 0; i < SIZE; ++i) remap[ReadIndex(_words, _bits, i)] = 1;
+
+		std::vector<T> palette;
+		for(size_t p = 0; p < _palette.size(); ++p) {
+			if(remap[p]) {
+				remap[p] = palette.size();
+				palette.push_back(_palette[p]);
+			}
+		}
+		if(palette.size() == _palette.size()) return;
+
+		const size_t bits = BitsFor(palette.size());
+		std::vector<uint64> words;
+		if(bits > 0) {
+			const size_t perWord = 64/bits;
+			words.assign((SIZE + perWord-1)/perWord, 0);
+			for(size_t i = 0; i < SIZE; ++i)
+				words[i/perWord] |= ((uint64)remap[ReadIndex(_words, _bits, i)]) << ((i%perWord)*bits);
+		}
+		_palette = std::move(palette);
+		_words = std::move(words);
+		_bits = bits;
+	}
+
+	/** Say if every element have the same value. */
+	inline bool IsUniform() const { return _bits == 0; }
+
+	/** Number of bits per element. */
+	inline size_t GetBitsPerElement() const { return _bits; }
+
+	/** Number of distinct values in the palette. */
+	inline size_t GetPaletteSize() const { return _palette.size(); }
+
+	/** Memory used by the array, in bytes. */
+	inline size_t GetMemoryUsage() const
+	{
+		return sizeof(*this) + _palette.capacity()*sizeof(T) + _words.capacity()*sizeof(uint64);
+	}
+
+	/** Accessing array as a one dimensional array. */
+	inline T operator[] (size_t i) const { return Get(i); }
+
+	/** Accessing array as a one dimensional array. */
+	inline Reference operator[] (size_t i) { return Reference(*this, i); }
+
+	/** Get element at given coordinate. */
+	inline T operator() (const Coordinates& coords) const { return Get(IndexAt(coords)); }
+
+	/** Get element at given coordinate. */
+	inline Reference operator() (const Coordinates& coords) { return Reference(*this, IndexAt(coords)); }
+
+	static_assert(
+		std::is_unsigned<T>() && sizeof(T) <= 2,
+		"Palette arrays store voxel IDs of 8 or 16 bits."
+	);
+};
+
+template<typename T, size_t... DIMS>
+using SPaletteArray = PaletteArray<IndexingMode::S_ORDERING, T, DIMS...>;
+
+#include "PaletteArray.inl"
+
+/** Unit test for PaletteArray class. */
+void unitests_palette_array();
+
+} // namespace HyperV
\ No newline at end of file
@@ -1 +1,110 @@
-//Empty
+#include "Procedural.hpp"
+
+#include <cstring>
+#include <vector>
+
+void HyperV::unitests_procedural()
+{
+	using namespace Procedural;
+
+	// Batch must give the same bits as one by one, on a row crossing cells.
+	std::vector<Vector3f> row;
+	for(int k = -40; k < 40; ++k) row.emplace_back(k*0.5f + 0.25f, -3.25f, 7.75f);
+	std::vector<float> noises(row.size());
+	PerlinNoiseBatch<3>(row.data(), row.size(), Vector3f(0.1875f, 0.1875f, 0.1875f), 7.0f, noises.data());
+	for(size_t k = 0; k < row.size(); ++k) {
+		const float expected = PerlinNoise<3>(row[k], Vector3f(0.1875f, 0.1875f, 0.1875f), 7.0f);
+		ASSERT_ALWAYS(noises[k] == expected, "Batch noise differ from noise.");
+	}
+
+	// And on scattered positions, where the cache is useless.
+	std::vector<Vector2f> points;
+	for(int k = 0; k < 100; ++k) points.emplace_back(RNG(k+1.0f, 3.0f)*200.0f - 100.0f, RNG(k+1.0f, 5.0f)*200.0f - 100.0f);
+	noises.resize(points.size());
+	PerlinNoiseBatch<2>(points.data(), points.size(), Vector2f(0.25f, 0.5f), 3.0f, noises.data());
+	for(size_t k = 0; k < points.size(); ++k) {
+		const float expected = PerlinNoise<2>(points[k], Vector2f(0.25f, 0.5f), 3.0f);
+		ASSERT_ALWAYS(noises[k] == expected, "Batch noise differ from noise.");
+	}
+
+	// Integer hashes are usable at compile time.
+	static_assert(Hash::Cell<2>({0, 0}, 1) != Hash::Cell<2>({1, 0}, 1), "Neighbors cells must differ.");
+	static_assert(Hash::Cell<2>({1, 0}, 1) != Hash::Cell<2>({0, 1}, 1), "Hash must depend on the axis.");
+	static_assert(HashLattice::At<3>({-5, 7, 1000000}, 7.0f) < 1.0f, "Lattice value must be inside [0, 1[.");
+
+	// Hash noise : values on vertices are the lattice, inside [0, 1], and evenly spread.
+	ASSERT_ALWAYS(PerlinNoise<2>(Vector2f(3, -2), Vector2f(1, 1), 7.0f, HashLattice()) == HashLattice::At<2>({3, -2}, 7.0f), "Noise on a vertex must be the lattice value.");
+	float mean = 0;
+	for(int k = 0; k < 1000; ++k) {
+		const float noise = PerlinNoise<3>(Vector3f(k*1.37f, k*0.11f - 50.0f, 1e6f), Vector3f(1, 1, 1), 7.0f, HashLattice());
+		ASSERT_ALWAYS(noise >= 0.0f && noise <= 1.0f, "Hash noise out of range.");
+		mean += noise/1000;
+	}
+	ASSERT_ALWAYS(std::abs(mean - 0.5f) < 0.05f, "Hash noise must be centered.");
+	ASSERT_ALWAYS(PerlinNoise<2>(Vector2f(1, 1), Vector2f(0.5f, 0.5f), 7.0f, HashLattice()) != PerlinNoise<2>(Vector2f(1, 1), Vector2f(0.5f, 0.5f), 8.0f, HashLattice()), "Seed must change the noise.");
+
+	PerlinNoiseBatch<3>(row.data(), row.size(), Vector3f(0.1875f, 0.1875f, 0.1875f), 7.0f, noises.data(), HashLattice());
+	for(size_t k = 0; k < row.size(); ++k) {
+		const float expected = PerlinNoise<3>(row[k], Vector3f(0.1875f, 0.1875f, 0.1875f), 7.0f, HashLattice());
+		ASSERT_ALWAYS(noises[k] == expected, "Batch hash noise differ from hash noise.");
+	}
+
+	// Hash batches are hashed in SIMD lanes : same bits on scattered and negative positions, with a partial last block.
+	noises.resize(points.size() - 3);
+	PerlinNoiseBatch<2>(points.data(), noises.size(), Vector2f(0.25f, 0.5f), 3.0f, noises.data(), HashLattice());
+	for(size_t k = 0; k < noises.size(); ++k) {
+		const float expected = PerlinNoise<2>(points[k], Vector2f(0.25f, 0.5f), 3.0f, HashLattice());
+		ASSERT_ALWAYS(std::memcmp(&noises[k], &expected, sizeof(float)) == 0, "Batch hash noise differ from hash noise.");
+	}
+	std::vector<Vector4f> points4;
+	for(int k = 0; k < 53; ++k) points4.emplace_back(points[k][0], points[k][1], -points[k+1][0]*3.0f, k*0.37f);
+	noises.resize(points4.size());
+	PerlinNoiseBatch<4>(points4.data(), points4.size(), Vector4f(0.3f, 0.7f, 1.1f, 0.5f), -9.0f, noises.data(), HashLattice());
+	for(size_t k = 0; k < points4.size(); ++k) {
+		const float expected = PerlinNoise<4>(points4[k], Vector4f(0.3f, 0.7f, 1.1f, 0.5f), -9.0f, HashLattice());
+		ASSERT_ALWAYS(std::memcmp(&noises[k], &expected, sizeof(float)) == 0, "Batch hash noise differ from hash noise.");
+	}
+
+	// Simplex noise : inside [0, 1] unclamped, spread, centered, and continuous, in 2, 3 and 4 dimensions.
+	float mean2 = 0, mean4 = 0, maxStep = 0, low3 = 1, high3 = 0;
+	for(int k = 0; k < 1000; ++k) {
+		const Vector3f p(k*0.173f, k*0.071f - 20.0f, 3.3f);
+		const float noise3 = SimplexNoise<3>(p, Vector3f(1, 1, 1), 7.0f);
+		const float next3 = SimplexNoise<3>(Vector3f(p + Vector3f(0.001f, 0, 0)), Vector3f(1, 1, 1), 7.0f);
+		const float noise2 = SimplexNoise<2>(Vector2f(p[0], p[1]), Vector2f(1, 1), 7.0f);
+		const float noise4 = SimplexNoise<4>(Vector4f(p[0], p[1], p[2], k*0.03f), Vector4f(1, 1, 1, 1), 7.0f);
+		ASSERT_ALWAYS(noise2 >= 0.0f && noise2 <= 1.0f, "Simplex noise out of range.");
+		ASSERT_ALWAYS(noise3 >= 0.0f && noise3 <= 1.0f, "Simplex noise out of range.");
+		ASSERT_ALWAYS(noise4 >= 0.0f && noise4 <= 1.0f, "Simplex noise out of range.");
+		low3 = std::min(low3, noise3);
+		high3 = std::max(high3, noise3);
+		maxStep = std::max(maxStep, std::abs(next3 - noise3));
+		mean2 += noise2/1000;
+		mean4 += noise4/1000;
+	}
+	ASSERT_ALWAYS(low3 < 0.25f && high3 > 0.75f, "Simplex noise must use most of its range.");
+	ASSERT_ALWAYS(maxStep < 0.05f, "Simplex noise must be continuous.");
+	ASSERT_ALWAYS(std::abs(mean2 - 0.5f) < 0.05f && std::abs(mean4 - 0.5f) < 0.05f, "Simplex noise must be centered.");
+
+	// Beyond the measured scales, the bound of the kernels keep it inside [0, 1].
+	static_assert(SimplexScale<9>() > 0.0f && SimplexScale<9>() < SimplexScale<8>(), "Simplex scale must be bounded.");
+	for(int k = 0; k < 200; ++k) {
+		VectorNf<9> p9;
+		for(size_t n = 0; n < 9; ++n) p9[n] = RNG(k + n*0.5f + 1.0f, 3.0f)*40.0f - 20.0f;
+		const float noise9 = SimplexNoise<9>(p9, VectorNf<9>::Constant(1.0f), 7.0f);
+		ASSERT_ALWAYS(noise9 >= 0.0f && noise9 <= 1.0f, "Simplex noise out of range.");
+	}
+
+	// fBm of one octave is the noise itself, more octaves stay inside [0, 1].
+	auto simplex = [](const Vector3f& p) { return SimplexNoise<3>(p, Vector3f(0.25f, 0.25f, 0.25f), 7.0f); };
+	const Vector3f p(1.5f, -2.25f, 8.0f);
+	ASSERT_ALWAYS(FBM<3>(p, simplex, 1) == simplex(p), "One octave fBm must be the noise.");
+	const float fbm = FBM<3>(p, simplex, 6, 2.0f, 0.5f);
+	ASSERT_ALWAYS(fbm >= 0.0f && fbm <= 1.0f, "fBm out of range.");
+
+	// Domain warping move each axis by at most its strength.
+	const Vector3f warped = DomainWarp<3>(p, [](const Vector3f& q, size_t axis) {
+		return SimplexNoise<3>(q, Vector3f(0.5f, 0.5f, 0.5f), 11.0f + axis);
+	}, 2.0f);
+	ASSERT_ALWAYS((warped - p).cwiseAbs().maxCoeff() <= 2.0f && warped != p, "Domain warp must move the position by at most its strength.");
+}
\ No newline at end of file
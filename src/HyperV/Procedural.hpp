@@ -5,6 +5,10 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+
+#include "Lanes.hpp"
 #include "Util.hpp"
 
 namespace HyperV {
@@ -12,16 +16,16 @@ namespace HyperV {
 namespace Procedural {
 	/** RNG 1D */
 	static inline float RNG(float x, float seed) {
-		ASSERT(!std::isnan(x), "Input cannot be NaN.");
-		ASSERT(!std::isinf(x), "Input cannot be infinite.");
-		ASSERT(!std::isnan(seed), "Seed cannot be NaN.");
-		ASSERT(!std::isinf(seed), "Seed cannot be infinite.");
-		ASSERT(seed != 0, "Seed cannot be 0."); // Nothing will happened if seed equal 0.
+		ASSERT_PARANOID(!std::isnan(x), "Input cannot be NaN.");
+		ASSERT_PARANOID(!std::isinf(x), "Input cannot be infinite.");
+		ASSERT_PARANOID(!std::isnan(seed), "Seed cannot be NaN.");
+		ASSERT_PARANOID(!std::isinf(seed), "Seed cannot be infinite.");
+		ASSERT_PARANOID(seed != 0, "Seed cannot be 0."); // Nothing will happened if seed equal 0.
 	    auto value = Math::fract(std::sin(x*seed)*3450206.7354991f);
-	    ASSERT(value <= 1.0f+Math::EPS, "RNG cannot be higher than 1.");
-	   	ASSERT(value >= 0.0f-Math::EPS, "RNG cannot be lower than 0.");
-	   	ASSERT(!std::isnan(value), "RNG cannot be NaN.");
-		ASSERT(!std::isinf(value), "RNG cannot be infinite.");
+	    ASSERT_PARANOID(value <= 1.0f+Math::EPS, "RNG cannot be higher than 1.");
+	   	ASSERT_PARANOID(value >= 0.0f-Math::EPS, "RNG cannot be lower than 0.");
+	   	ASSERT_PARANOID(!std::isnan(value), "RNG cannot be NaN.");
+		ASSERT_PARANOID(!std::isinf(value), "RNG cannot be infinite.");
 	    return value;
 	}
 
@@ -33,8 +37,8 @@ namespace Procedural {
 			return T();
 		else {
 			auto u = RNG_VEC<N, T, I+1>(worldPos, seed);
-			ASSERT(!std::isnan(worldPos[I]), "World position cannot be NaN.");
-			ASSERT(!std::isinf(worldPos[I]), "World position cannot be infinite.");
+			ASSERT_PARANOID(!std::isnan(worldPos[I]), "World position cannot be NaN.");
+			ASSERT_PARANOID(!std::isinf(worldPos[I]), "World position cannot be infinite.");
 			u[I] = RNG(worldPos[I], seed+I*95643.45224f);
 			return u;
 		}
@@ -46,29 +50,96 @@ namespace Procedural {
 	{
 		auto randomVec = RNG_VEC<N, T>(v, seed);
 	    auto value = Math::fract(std::sin(Math::dot<N>(v, randomVec))*43758.5453123f);
-	   	ASSERT(value <= 1.0f+Math::EPS, "RNG cannot be higher than 1.");
-	   	ASSERT(value >= 0.0f-Math::EPS, "RNG cannot be lower than 0.");
-	   	ASSERT(!std::isnan(value), "RNG cannot be NaN.");
-		ASSERT(!std::isinf(value), "RNG cannot be infinite.");
+	   	ASSERT_PARANOID(value <= 1.0f+Math::EPS, "RNG cannot be higher than 1.");
+	   	ASSERT_PARANOID(value >= 0.0f-Math::EPS, "RNG cannot be lower than 0.");
+	   	ASSERT_PARANOID(!std::isnan(value), "RNG cannot be NaN.");
+		ASSERT_PARANOID(!std::isinf(value), "RNG cannot be infinite.");
 	    return value;
 	}
 
 	/**
-	 * Perlin noise in N dimensional space.
-	 * - worldPos : Position in the world.
-	 * - cellPerUnit : Number of cell per world's unit.
-	 * - seed : Any random number except for 0.
-	 * - N : Number of dimensions.
-	 * - T : Type used for vectors.
+	 * Integer hashes, (xxHash32 like), of coordinates on a lattice.
+	 * Unlike RNG, they are constexpr, exact for any coordinates,
+	 * and give the same bits with any compiler or libm.
 	 */
-	template<size_t N, typename T, typename E>
-	static float PerlinNoise(const T& worldPos, const E& cellPerUnit, float seed) {
-		assert(std::abs(seed) > 0.0000001); // Seed 0 is banned !
-	    
-	    auto buffer = Math::Mul<N>(worldPos, cellPerUnit);
-	    std::array<  int, N> i = Math::vec_cast<N, std::array<  int, N>,   int>(Math::floor<N>(buffer));
-	    std::array<float, N> f = Math::vec_cast<N, std::array<float, N>, float>(Math::fract<N>(buffer));
+	namespace Hash {
+		constexpr uint32 PRIME1 = 0x9E3779B1U;
+		constexpr uint32 PRIME2 = 0x85EBCA77U;
+		constexpr uint32 PRIME3 = 0xC2B2AE3DU;
+		constexpr uint32 PRIME4 = 0x27D4EB2FU;
+		constexpr uint32 PRIME5 = 0x165667B1U;
+
+		static inline constexpr uint32 Rotl(uint32 x, uint32 r) { return (x << r) | (x >> (32-r)); }
+
+		/** Mix bits so each bit of input change half of the output. */
+		static inline constexpr uint32 Avalanche(uint32 h)
+		{
+			h ^= h >> 15;
+			h *= PRIME2;
+			h ^= h >> 13;
+			h *= PRIME3;
+			h ^= h >> 16;
+			return h;
+		}
+
+		/** Hash of integer coordinates, for given seed. */
+		template<size_t N>
+		static inline constexpr uint32 Cell(const std::array<int, N>& cell, uint32 seed)
+		{
+			uint32 h = seed + PRIME5 + (uint32)(N*4);
+			for(size_t n = 0; n < N; ++n)
+				h = Rotl(h + (uint32)cell[n]*PRIME3, 17) * PRIME4;
+			return Avalanche(h);
+		}
+
+		/** 64 bits hash, to derive seeds (SplitMix64). */
+		static inline constexpr uint64 SplitMix(uint64 x)
+		{
+			x += 0x9E3779B97F4A7C15UL;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9UL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBUL;
+			return x ^ (x >> 31);
+		}
+
+		/** Hash to a float inside [0, 1[, from its 24 higher bits. */
+		static inline constexpr float ToUnit(uint32 h)
+		{
+			return (h >> 8) * (1.0f/16777216.0f);
+		}
+
+		/** Integer seed from the float seeds used by noises. */
+		static inline constexpr uint32 Seed(float seed)
+		{
+			return (uint32)SplitMix((uint64)(int64)(seed*65536.0f));
+		}
+	}
+
+	/** Values of the vertices of a noise's lattice, given by the sin based RNG. */
+	struct SinLattice {
+		template<size_t N>
+		static inline float At(const std::array<int, N>& cell, float seed)
+		{
+			return RNG<N>(Math::vec_cast<N, std::array<float, N>, float>(cell), seed);
+		}
+	};
+
+	/** Values of the vertices of a noise's lattice, given by integer hashes. */
+	struct HashLattice {
+		template<size_t N>
+		static inline constexpr float At(const std::array<int, N>& cell, float seed)
+		{
+			return Hash::ToUnit(Hash::Cell<N>(cell, Hash::Seed(seed)));
+		}
+	};
 
+	/**
+	 * Random values of the 2^N vertices of the cell at integer coordinates i,
+	 * shared by PerlinNoise and PerlinNoiseBatch.
+	 * - L : Lattice giving the value of each vertex.
+	 */
+	template<size_t N, typename L = SinLattice>
+	static inline std::array<float, Math::pow<2, N>()> PerlinCorners(const std::array<int, N>& i, float seed)
+	{
 	    /** Generate a RNG for each verticices inside an n-hypercube. */
 	    constexpr auto NVERTICES = Math::pow<2, N>();
 	    std::array<float, NVERTICES> v;
@@ -77,21 +148,287 @@ namespace Procedural {
 	    std::array<size_t, N> forloop_limits;
 		std::fill_n(forloop_limits.begin(), N, 2);
 	    Misc::NestedForLoops<N>([&](const std::array<size_t, N>& coords) {
-	        *it_v = RNG<N>(Math::vec_cast<N, std::array<float, N>, float>(Math::Add<N>(i, coords)), seed);
+	        std::array<int, N> vertex;
+	        for(size_t n = 0; n < N; ++n) vertex[n] = i[n] + (int)coords[n];
+	        *it_v = L::template At<N>(vertex, seed);
 	        ++it_v;
 	       	NFL_LAST_CALL;
 	    }, forloop_limits);
+	    return v;
+	}
+
+	/**
+	 * Perlin noise in N dimensional space.
+	 * - worldPos : Position in the world.
+	 * - cellPerUnit : Number of cell per world's unit.
+	 * - seed : Any random number except for 0.
+	 * - L : SinLattice or HashLattice, source of randomness, passed as a tag (HashLattice()) or as template argument.
+	 * - N : Number of dimensions.
+	 * - T : Type used for vectors.
+	 */
+	template<size_t N, typename T, typename E, typename L = SinLattice>
+	static float PerlinNoise(const T& worldPos, const E& cellPerUnit, float seed, L = L()) {
+		ASSERT(std::abs(seed) > 0.0000001f, "Seed 0 is banned !");
+	    
+	    auto buffer = Math::Mul<N>(worldPos, cellPerUnit);
+	    std::array<  int, N> i = Math::vec_cast<N, std::array<  int, N>,   int>(Math::floor<N>(buffer));
+	    std::array<float, N> f = Math::vec_cast<N, std::array<float, N>, float>(Math::fract<N>(buffer));
+
+	    auto v = PerlinCorners<N, L>(i, seed);
 
 	   	// Interpolate on all verticies :
 	    auto noise = Math::nlerp<N>(v, Math::cubic_hermite_curve<N>(f));
 	   	//auto noise = Math::nlerp<N>(v, Math::quintic_curve<N>(f));
 
-	    ASSERT(noise <= 1.0f+Math::EPS, "Noise cannot be higher than 1.");
-	   	ASSERT(noise >= 0.0f-Math::EPS, "Noise cannot be lower than 0.");
+	    ASSERT_PARANOID(noise <= 1.0f+Math::EPS, "Noise cannot be higher than 1.");
+	   	ASSERT_PARANOID(noise >= 0.0f-Math::EPS, "Noise cannot be lower than 0.");
 	   	return noise;
 	}
 
+	/** Number of cells remembered by PerlinNoiseBatch. */
+	constexpr size_t PERLIN_CACHE_SIZE = 16;
+
+	/**
+	 * PerlinNoiseBatch on a HashLattice, Lanes::WIDTH positions at once :
+	 * their cells, and the hashes of the 2^N vertices of those, are computed
+	 * in SIMD lanes, with the same operations as Hash::Cell. Interpolations
+	 * stay scalar, so noises have the same bits as PerlinNoise's, as long
+	 * as the compiler doesn't contract them into FMAs differently.
+	 */
+	template<size_t N, typename T, typename E>
+	static void PerlinNoiseLanes(const T* worldPos, size_t count, const E& cellPerUnit, float seed, float* noises) {
+		constexpr size_t W = Lanes::WIDTH;
+		constexpr auto NVERTICES = Math::pow<2, N>();
+		const Lanes::Int h0 = Lanes::Set(Hash::Seed(seed) + Hash::PRIME5 + (uint32)(N*4));
+
+		std::array<std::array<float, W>, N> scaled, f;
+		std::array<std::array<uint32, W>, NVERTICES> hashes;
+		Lanes::Int cell[N];
+
+		for(size_t k = 0; k < count; k += W) {
+			// The last block is padded with its last position.
+			const size_t lanes = std::min(W, count - k);
+			for(size_t l = 0; l < W; ++l) {
+				auto buffer = Math::Mul<N>(worldPos[k + std::min(l, lanes-1)], cellPerUnit);
+				for(size_t n = 0; n < N; ++n) scaled[n][l] = buffer[n];
+			}
+			for(size_t n = 0; n < N; ++n) {
+				const Lanes::Float x = Lanes::Load(scaled[n].data());
+				const Lanes::Float floored = Lanes::Floor(x);
+				Lanes::Store(f[n].data(), Lanes::Sub(x, floored));
+				cell[n] = Lanes::ToInt(floored);
+			}
+
+			// Vertex c is at cell + ((c>>n)&1) along each axis n, as in PerlinCorners.
+			for(size_t c = 0; c < NVERTICES; ++c) {
+				Lanes::Int h = h0;
+				for(size_t n = 0; n < N; ++n) {
+					const Lanes::Int vertex = ((c >> n) & 1) ? Lanes::Add(cell[n], Lanes::Set(1)) : cell[n];
+					h = Lanes::Add(h, Lanes::Mul(vertex, Lanes::Set(Hash::PRIME3)));
+					h = Lanes::Mul(Lanes::Rotl<17>(h), Lanes::Set(Hash::PRIME4));
+				}
+				h = Lanes::Xor(h, Lanes::ShiftRight<15>(h));
+				h = Lanes::Mul(h, Lanes::Set(Hash::PRIME2));
+				h = Lanes::Xor(h, Lanes::ShiftRight<13>(h));
+				h = Lanes::Mul(h, Lanes::Set(Hash::PRIME3));
+				h = Lanes::Xor(h, Lanes::ShiftRight<16>(h));
+				Lanes::Store(hashes[c].data(), h);
+			}
+
+			for(size_t l = 0; l < lanes; ++l) {
+				std::array<float, NVERTICES> v;
+				for(size_t c = 0; c < NVERTICES; ++c) v[c] = Hash::ToUnit(hashes[c][l]);
+				std::array<float, N> fl;
+				for(size_t n = 0; n < N; ++n) fl[n] = f[n][l];
+				noises[k+l] = Math::nlerp<N>(v, Math::cubic_hermite_curve<N>(fl));
+			}
+		}
+	}
+
+	/**
+	 * Perlin noise of 'count' positions at once, written into 'noises'.
+	 * Give exactly the same values as PerlinNoise, but the random values
+	 * of the vertices of a cell, (2^N RNG calls, by far the most expensive
+	 * part), are computed once and kept in a small cache while neighbors
+	 * positions fall in the same cell. Give it rows or bricks of voxels.
+	 * A HashLattice is hashed in SIMD lanes instead, when the target has some.
+	 */
+	template<size_t N, typename T, typename E, typename L = SinLattice>
+	static void PerlinNoiseBatch(const T* worldPos, size_t count, const E& cellPerUnit, float seed, float* noises, L = L()) {
+		ASSERT(std::abs(seed) > 0.0000001f, "Seed 0 is banned !");
+		if constexpr(std::is_same<L, HashLattice>::value && Lanes::WIDTH > 1) {
+			PerlinNoiseLanes<N>(worldPos, count, cellPerUnit, seed, noises);
+			return;
+		}
+		constexpr auto NVERTICES = Math::pow<2, N>();
+
+		// Direct mapped cache of the vertices of the last cells.
+		std::array<std::array<int, N>, PERLIN_CACHE_SIZE> cells;
+		std::array<std::array<float, NVERTICES>, PERLIN_CACHE_SIZE> corners;
+		std::array<bool, PERLIN_CACHE_SIZE> used{};
+
+		for(size_t k = 0; k < count; ++k) {
+		    auto buffer = Math::Mul<N>(worldPos[k], cellPerUnit);
+		    std::array<  int, N> i = Math::vec_cast<N, std::array<  int, N>,   int>(Math::floor<N>(buffer));
+		    std::array<float, N> f = Math::vec_cast<N, std::array<float, N>, float>(Math::fract<N>(buffer));
+
+		    size_t slot = 0;
+		    for(size_t n = 0; n < N; ++n) slot = slot*31 + (size_t)i[n];
+		    slot %= PERLIN_CACHE_SIZE;
+		    if(!used[slot] || cells[slot] != i) {
+		    	corners[slot] = PerlinCorners<N, L>(i, seed);
+		    	cells[slot] = i;
+		    	used[slot] = true;
+		    }
+
+		    noises[k] = Math::nlerp<N>(corners[slot], Math::cubic_hermite_curve<N>(f));
+		    ASSERT_PARANOID(noises[k] <= 1.0f+Math::EPS, "Noise cannot be higher than 1.");
+		   	ASSERT_PARANOID(noises[k] >= 0.0f-Math::EPS, "Noise cannot be lower than 0.");
+		}
+	}
+
+	/** Squared radius of the kernel of each vertex of SimplexNoise. */
+	constexpr float SIMPLEX_RADIUS2 = 0.5f;
+
+	/**
+	 * Scale bringing the sum of the simplex kernels inside [-1, 1].
+	 * Up to 8 dimensions, 90% of the inverse of the highest sum found by
+	 * searching positions and seeds. Beyond, the inverse of a bound : each of
+	 * the N+1 kernels (R2-r^2)^4*(g.d) is at most (8*R2/9)^4 * sqrt(R2)/3 * |g|,
+	 * reached at r^2 = R2/9, with |g| = sqrt(N-1).
+	 */
+	template<size_t N>
+	static inline constexpr float SimplexScale()
+	{
+		constexpr float scales[] = {64.0f, 90.0f, 70.0f, 56.0f, 50.0f, 44.0f, 40.0f, 37.0f};
+		if constexpr(N <= 8) return scales[N-1];
+		else {
+			constexpr double R2 = SIMPLEX_RADIUS2;
+			constexpr double k = (8.0*R2/9.0)*(8.0*R2/9.0)*(8.0*R2/9.0)*(8.0*R2/9.0);
+			return (float)(1.0/((N+1)*k*Math::Sqrt(R2)/3.0*Math::Sqrt(N-1.0)));
+		}
+	}
+
+	/**
+	 * Simplex noise in N dimensional space, value inside [0, 1].
+	 * The space is skewed so each hypercube split into N! simplices, and
+	 * only the N+1 vertices of the simplex holding the position contribute,
+	 * instead of the 2^N vertices of PerlinNoise. Each vertex has a gradient
+	 * on an edge of the hypercube, chosen by hashing its coordinates.
+	 * - worldPos : Position in the world.
+	 * - cellPerUnit : Number of cell per world's unit.
+	 * - seed : Any random number.
+	 * - N : Number of dimensions.
+	 * - T : Type used for vectors.
+	 */
+	template<size_t N, typename T, typename E>
+	static float SimplexNoise(const T& worldPos, const E& cellPerUnit, float seed)
+	{
+		constexpr float F = (float)((Math::Sqrt(N+1.0)-1.0)/N);
+		constexpr float G = (float)((1.0-1.0/Math::Sqrt(N+1.0))/N);
+
+		// Skew position to find the hypercube.
+		std::array<float, N> x;
+		float skew = 0;
+		for(size_t n = 0; n < N; ++n) {
+			x[n] = worldPos[n]*cellPerUnit[n];
+			skew += x[n];
+		}
+		skew *= F;
+		std::array<int, N> cell;
+		int sumCell = 0;
+		for(size_t n = 0; n < N; ++n) {
+			cell[n] = (int)Math::floor(x[n]+skew);
+			sumCell += cell[n];
+		}
+
+		// Position relative to the first vertex, in unskewed space.
+		const float unskew = sumCell*G;
+		std::array<float, N> offset;
+		for(size_t n = 0; n < N; ++n) offset[n] = x[n] - (cell[n] - unskew);
+
+		// Vertices of the simplex are reached by walking axes by decreasing offset.
+		std::array<size_t, N> order;
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&offset](size_t a, size_t b) {
+			return offset[a] > offset[b];
+		});
+
+		const uint32 seedBits = Hash::Seed(seed);
+		float noise = 0;
+		std::array<int, N> vertex = cell;
+		for(size_t k = 0; k <= N; ++k) {
+			if(k > 0) {
+				++vertex[order[k-1]];
+				offset[order[k-1]] -= 1.0f;
+			}
+			std::array<float, N> d;
+			float dist2 = 0;
+			for(size_t n = 0; n < N; ++n) {
+				d[n] = offset[n] + k*G;
+				dist2 += d[n]*d[n];
+			}
+			float kernel = SIMPLEX_RADIUS2 - dist2;
+			if(kernel <= 0) continue;
+
+			// Gradient on an edge of the hypercube : +-1 on each axis but one.
+			const uint32 h = Hash::Cell<N>(vertex, seedBits);
+			const size_t skipped = (N > 1) ? (h >> 16) % N : N;
+			float gradient = 0;
+			for(size_t n = 0; n < N; ++n)
+				if(n != skipped) gradient += ((h >> n) & 0b1) ? -d[n] : d[n];
+
+			kernel *= kernel;
+			noise += kernel*kernel*gradient;
+		}
+
+		noise = 0.5f + 0.5f*SimplexScale<N>()*noise;
+		ASSERT_PARANOID(noise <= 1.0f && noise >= 0.0f, "Simplex noise out of range.");
+		return noise;
+	}
+
+	/**
+	 * Fractal brownian motion, sum of octaves of a noise, value inside [0, 1].
+	 * Each octave has its frequency multiplied by lacunarity, and its
+	 * amplitude by gain. Octaves are shifted from each other, so they don't
+	 * all cross the origin.
+	 * - noise : Function of a position, returning a value inside [0, 1].
+	 */
+	template<size_t N, typename T, typename F>
+	static float FBM(const T& worldPos, F noise, size_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f)
+	{
+		ASSERT(octaves > 0, "fBm need at least one octave.");
+		float sum = 0, amplitude = 1, sumAmplitude = 0, frequency = 1;
+		for(size_t o = 0; o < octaves; ++o) {
+			const T p = Math::AddScalar<N>(Math::MulScalar<N>(worldPos, frequency), o*19.19f);
+			sum += amplitude*noise(p);
+			sumAmplitude += amplitude;
+			amplitude *= gain;
+			frequency *= lacunarity;
+		}
+		return sum/sumAmplitude;
+	}
+
+	/**
+	 * Domain warping : position moved along each axis by a noise,
+	 * to feed into another noise for twisted shapes.
+	 * - noise : Function of (position, axis) returning a value inside [0, 1],
+	 *   use a different seed for each axis.
+	 * - strength : Maximal displacement on each axis, in world's unit.
+	 */
+	template<size_t N, typename T, typename F>
+	static T DomainWarp(const T& worldPos, F noise, float strength)
+	{
+		T warped = worldPos;
+		for(size_t n = 0; n < N; ++n)
+			warped[n] += (noise(worldPos, n)*2.0f - 1.0f)*strength;
+		return warped;
+	}
+
 #include "Procedural.inl"
 }
 
+/** Unit test for procedural methodes. */
+void unitests_procedural();
+
 } // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "Raycast.hpp"
+
+#include <random>
+
+#include "Terrain.hpp"
+
+void HyperV::unitests_raycast()
+{
+	// Cells are walked in order, one axis at a time.
+	{
+		using Cell = GridRay<2>::Cell;
+		const Vector2f dir = Vector2f(1.0f, 0.4f).normalized();
+		GridRay<2> ray(Vector2f(0.5f, 0.5f), dir, Vector2f(0, 0), Vector2f(1, 1), 0.0f, 2, Cell{0, 0}, Cell{100, 100});
+		ASSERT_ALWAYS(ray.GetFace() == GridRay<2>::NO_FACE, "Start cell must have no face.");
+		Cell last = ray.GetCell();
+		float distance = ray.GetDistance();
+		for(size_t i = 0; i < 20; ++i) {
+			ray.Next();
+			const Cell& cell = ray.GetCell();
+			ASSERT_ALWAYS(std::abs(cell[0]-last[0]) + std::abs(cell[1]-last[1]) == 1, "Ray must step into a cell next to the last.");
+			ASSERT_ALWAYS(ray.GetDistance() >= distance, "Cells must be walked in order.");
+			const Vector2f entry = Vector2f(0.5f, 0.5f) + dir*(ray.GetDistance() + ray.GetExitDistance())*0.5f;
+			ASSERT_ALWAYS((int64)std::floor(entry[0]) == cell[0] && (int64)std::floor(entry[1]) == cell[1], "Ray must be inside its cell.");
+			last = cell;
+			distance = ray.GetDistance();
+		}
+	}
+
+	using TestChunk = Chunk32<uint8>;
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+	static TestChunk chunk(32);
+	chunk.Fill(0);
+	chunk.SetVoxel({20, 16, 16}, 3);
+
+	// Voxel (20, 16, 16) is the box [4, 5] x [0, 1] x [0, 1].
+	TestChunk::RayHit hit;
+	ASSERT_ALWAYS(chunk.Raycast(Vector3f(-20.0f, 0.5f, 0.5f), Vector3f(1, 0, 0), 100.0f, voxelSet, hit), "Ray must hit the voxel.");
+	ASSERT_ALWAYS((hit.coords == TestChunk::VoxelArray::Coordinates{20, 16, 16}) && hit.voxelID == 3, "Ray must hit the right voxel.");
+	ASSERT_ALWAYS(hit.face == NEG_X && std::abs(hit.distance - 24.0f) < 1e-4f, "Ray must hit the face in front of it.");
+	ASSERT_ALWAYS(chunk.Raycast(Vector3f(10.0f, 0.7f, 0.2f), Vector3f(-1, 0, 0), 100.0f, voxelSet, hit), "Ray from inside must hit the voxel.");
+	ASSERT_ALWAYS(hit.face == POS_X && std::abs(hit.distance - 5.0f) < 1e-4f, "Ray from inside must hit the face in front of it.");
+	ASSERT_ALWAYS(chunk.Raycast(Vector3f(4.5f, 0.5f, 0.5f), Vector3f(0, 1, 0), 100.0f, voxelSet, hit), "Ray starting in a voxel must hit it.");
+	ASSERT_ALWAYS(hit.face == GridRay<3>::NO_FACE && hit.distance == 0.0f, "Ray starting in a voxel must hit no face.");
+	ASSERT_ALWAYS(!chunk.Raycast(Vector3f(-20.0f, 1.5f, 0.5f), Vector3f(1, 0, 0), 100.0f, voxelSet, hit), "Ray next to the voxel must miss it.");
+	ASSERT_ALWAYS(!chunk.Raycast(Vector3f(-20.0f, 0.5f, 0.5f), Vector3f(1, 0, 0), 23.0f, voxelSet, hit), "Short ray must miss the voxel.");
+	ASSERT_ALWAYS(!chunk.Raycast(Vector3f(-20.0f, 0.5f, 0.5f), Vector3f(-1, 0, 0), 100.0f, voxelSet, hit), "Ray going away must miss the chunk.");
+
+	// Skipping empty bricks must not change hits.
+	chunk.SetVoxel({3, 5, 7}, 3);
+	chunk.DrawSphere(Vector3f(-6.0f, 8.0f, -4.0f), 3.0f, 3);
+	ASSERT_ALWAYS(!chunk.IsBrickOccupancyCurrent(), "Brick occupancy must be stale after edits.");
+	ASSERT_ALWAYS(chunk.UpdateBrickOccupancy() == TestChunk::N_BRICKS, "First update must scan every brick.");
+	ASSERT_ALWAYS(chunk.UpdateBrickOccupancy() == 0, "Update without edits must scan nothing.");
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> uniform(-24.0f, 24.0f);
+	size_t nHits = 0;
+	for(size_t r = 0; r < 500; ++r) {
+		const Vector3f origin(uniform(rng), uniform(rng), uniform(rng));
+		const Vector3f target = Vector3f(uniform(rng), uniform(rng), uniform(rng))*0.5f;
+		const Vector3f dir = (target - origin).normalized();
+		TestChunk::RayHit walked, skipped;
+		const bool hitWalked = chunk.Raycast(origin, dir, 100.0f, voxelSet, walked);
+		const bool hitSkipped = chunk.Raycast(origin, dir, 100.0f, voxelSet, skipped, true);
+		ASSERT_ALWAYS(hitWalked == hitSkipped, "Skipping empty bricks must not change hits.");
+		if(!hitWalked) continue;
+		ASSERT_ALWAYS(walked.coords == skipped.coords && walked.face == skipped.face, "Skipping empty bricks must hit the same face.");
+		ASSERT_ALWAYS(std::abs(walked.distance - skipped.distance) < 1e-3f, "Skipping empty bricks must hit at the same distance.");
+		++nHits;
+	}
+	ASSERT_ALWAYS(nHits > 0, "Some random rays must hit.");
+	chunk.SetVoxel({20, 20, 20}, 3);
+	ASSERT_ALWAYS(chunk.UpdateBrickOccupancy() < TestChunk::N_BRICKS, "Update must only scan edited bricks.");
+
+	// Rays cross chunks, missing chunks are air.
+	{
+		Terrain<TestChunk> terrain(32);
+		terrain.CreateChunk({0, 0, 0}).Fill(0);
+		terrain.CreateChunk({1, 0, 0}).Fill(0);
+		terrain.CreateChunk({3, 0, 0}).Fill(0);
+		terrain.GetChunk({1, 0, 0})->SetVoxel({0, 16, 16}, 3);
+		terrain.GetChunk({3, 0, 0})->SetVoxel({0, 16, 16}, 3);
+
+		Terrain<TestChunk>::RayHit terrainHit;
+		ASSERT_ALWAYS(terrain.Raycast(Vector3f(-10.0f, 0.5f, 0.5f), Vector3f(1, 0, 0), 200.0f, voxelSet, terrainHit), "Ray must hit the next chunk.");
+		ASSERT_ALWAYS((terrainHit.chunkCoords == Terrain<TestChunk>::Coords{1, 0, 0}) && terrainHit.voxel.face == NEG_X, "Ray must hit the next chunk's face.");
+		ASSERT_ALWAYS(std::abs(terrainHit.voxel.distance - 26.0f) < 1e-4f, "Ray must hit at the border of the chunks.");
+		ASSERT_ALWAYS(terrain.Raycast(Vector3f(17.5f, 0.5f, 0.5f), Vector3f(1, 0, 0), 200.0f, voxelSet, terrainHit), "Ray must cross a missing chunk.");
+		ASSERT_ALWAYS((terrainHit.chunkCoords == Terrain<TestChunk>::Coords{3, 0, 0}) && std::abs(terrainHit.voxel.distance - 62.5f) < 1e-4f, "Ray must hit the far chunk.");
+		ASSERT_ALWAYS(!terrain.Raycast(Vector3f(17.5f, 0.5f, 0.5f), Vector3f(1, 0, 0), 50.0f, voxelSet, terrainHit), "Short ray must stop before the far chunk.");
+	}
+
+	// Raycasts work in any dimension.
+	{
+		using Chunk4D = Chunk<IndexingMode::S_ORDERING, uint8, 8, 8, 8, 8>;
+		static Chunk4D hyper(8);
+		hyper.Fill(0);
+		hyper.SetVoxel({4, 4, 4, 6}, 3);
+		Chunk4D::RayHit hyperHit;
+		ASSERT_ALWAYS(hyper.Raycast(VectorNf<4>::Constant(0.5f), VectorNf<4>(0, 0, 0, 1), 10.0f, voxelSet, hyperHit), "4D ray must hit the voxel.");
+		ASSERT_ALWAYS(hyperHit.face == 2*3+1 && std::abs(hyperHit.distance - 1.5f) < 1e-4f, "4D ray must hit the face in front of it.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+/**
+ * \author Asso Corentin
+ * \Date May 18 2021
+ * \Desc Traversal of the cells of a grid along a ray, to raycast voxels.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "Util.hpp"
+
+namespace HyperV {
+
+/**
+ * Clip a ray starting at origin, along dir, against the box [boxMin, boxMax].
+ * tEnter and tExit are set to the distances (in lengths of dir) where the
+ * ray enter and exit the box, and axis to the axis of the face it enter by,
+ * or N if origin is inside. Return false if the ray miss the box.
+ */
+template<size_t N>
+inline bool ClipRay(
+	const VectorNf<N>& origin, const VectorNf<N>& dir,
+	const VectorNf<N>& boxMin, const VectorNf<N>& boxMax,
+	float& tEnter, float& tExit, size_t& axis)
+{
+	tEnter = 0.0f;
+	tExit = std::numeric_limits<float>::infinity();
+	axis = N;
+	for(size_t n = 0; n < N; ++n) {
+		if(dir[n] == 0.0f) {
+			if(origin[n] < boxMin[n] || origin[n] > boxMax[n]) return false;
+			continue;
+		}
+		float t0 = (boxMin[n] - origin[n])/dir[n];
+		float t1 = (boxMax[n] - origin[n])/dir[n];
+		if(t0 > t1) std::swap(t0, t1);
+		if(t0 > tEnter) {
+			tEnter = t0;
+			axis = n;
+		}
+		tExit = std::min(tExit, t1);
+	}
+	return tEnter <= tExit;
+}
+
+/**
+ * Traversal of the cells of an N dimensional grid pierced by a ray, in
+ * order, as done by Amanatides and Woo : for each axis, the distance to
+ * the next cell border is kept, and the ray step into the cell whose
+ * border is the nearest, with a few additions per cell.
+ * Cell 0 of the grid start at 'corner', cells are 'cellSize' wide.
+ */
+template<size_t N>
+class GridRay {
+public:
+	using Cell = std::array<int64, N>;
+
+	/** Face of a cell the ray entered by, when it started inside. */
+	static constexpr size_t NO_FACE = 2*N;
+
+private:
+	/** Current cell. */
+	Cell _cell;
+
+	/** Direction of the steps along each axis, -1, 0 or 1. */
+	std::array<int64, N> _step;
+
+	/** Distance at which the ray cross the next cell border, along each axis. */
+	std::array<float, N> _tMax;
+
+	/** Distance between two cell borders, along each axis. */
+	std::array<float, N> _tDelta;
+
+	/** Distance at which the ray entered the current cell. */
+	float _t;
+
+	/** Axis crossed to enter the current cell, N if the ray started in it. */
+	size_t _axis;
+
+public:
+	/**
+	 * Start the traversal at distance tStart, in the cell of the grid
+	 * [lo, hi[ holding that point. 'axis' is the axis whose border the ray
+	 * cross at tStart, along which the cell is chosen by the direction of
+	 * the ray rather than by rounding, or N if it cross none.
+	 */
+	GridRay(
+		const VectorNf<N>& origin, const VectorNf<N>& dir,
+		const VectorNf<N>& corner, const VectorNf<N>& cellSize,
+		float tStart, size_t axis, const Cell& lo, const Cell& hi) :
+		_t(tStart), _axis(axis)
+	{
+		constexpr float INF = std::numeric_limits<float>::infinity();
+		for(size_t n = 0; n < N; ++n) {
+			const float p = (origin[n] + dir[n]*tStart - corner[n])/cellSize[n];
+			if(n == axis) _cell[n] = (int64)std::round(p) - (dir[n] < 0 ? 1 : 0);
+			else _cell[n] = (int64)std::floor(p);
+			_cell[n] = std::clamp(_cell[n], lo[n], hi[n]-1);
+
+			if(dir[n] > 0) {
+				_step[n] = 1;
+				_tDelta[n] = cellSize[n]/dir[n];
+				_tMax[n] = (corner[n] + (_cell[n]+1)*cellSize[n] - origin[n])/dir[n];
+			} else if(dir[n] < 0) {
+				_step[n] = -1;
+				_tDelta[n] = -cellSize[n]/dir[n];
+				_tMax[n] = (corner[n] + _cell[n]*cellSize[n] - origin[n])/dir[n];
+			} else {
+				_step[n] = 0;
+				_tDelta[n] = INF;
+				_tMax[n] = INF;
+			}
+		}
+	}
+
+	/** Step into the next cell. */
+	inline void Next()
+	{
+		size_t axis = 0;
+		for(size_t n = 1; n < N; ++n)
+			if(_tMax[n] < _tMax[axis]) axis = n;
+		_t = _tMax[axis];
+		_cell[axis] += _step[axis];
+		_tMax[axis] += _tDelta[axis];
+		_axis = axis;
+	}
+
+	/** Current cell. */
+	inline const Cell& GetCell() const { return _cell; }
+
+	/** Say if the current cell is in the grid [lo, hi[. */
+	inline bool IsIn(const Cell& lo, const Cell& hi) const
+	{
+		for(size_t n = 0; n < N; ++n)
+			if(_cell[n] < lo[n] || _cell[n] >= hi[n]) return false;
+		return true;
+	}
+
+	/** Distance at which the ray entered the current cell. */
+	inline float GetDistance() const { return _t; }
+
+	/** Distance at which the ray exit the current cell. */
+	inline float GetExitDistance() const { return *std::min_element(_tMax.begin(), _tMax.end()); }
+
+	/** Axis crossed to enter the current cell, N if the ray started in it. */
+	inline size_t GetAxis() const { return _axis; }
+
+	/** Face of the current cell the ray entered by (E_NEIGHBOR order in 3D), NO_FACE if it started in it. */
+	inline size_t GetFace() const
+	{
+		if(_axis == N) return NO_FACE;
+		return 2*_axis + (_step[_axis] > 0 ? 1 : 0);
+	}
+};
+
+/** Unit test for raycasts. */
+void unitests_raycast();
+
+} // namespace HyperV
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "RunLength.hpp"
+#include "Chunk.hpp"
+
+void HyperV::unitests_run_length()
+{
+	// Layered chunk : air above, three bands below.
+	auto layers = [](const auto&, const VectorNf<3>, const std::array<size_t, 3>& coords, uint8) -> uint8 {
+		if(coords[1] >= 12) return 0;
+		if(coords[1] >= 10) return 1;
+		if(coords[1] >= 6) return 2;
+		return 3;
+	};
+	Chunk16<uint8> chunk(16);
+	chunk.Procedural(layers);
+	RunLength<uint8> code = chunk.Compress();
+	ASSERT_ALWAYS(code.GetSize() == Chunk16<uint8>::CAPACITY, "Code must cover the whole chunk.");
+	ASSERT_ALWAYS(code.GetRunCount() == 4*16, "Each slice of a layered chunk must be four runs.");
+	ASSERT_ALWAYS(code.GetMemoryUsage()*8 < Chunk16<uint8>::CAPACITY, "Layered chunk must compress.");
+
+	Chunk16<uint8> decoded(16);
+	decoded.Fill(9);
+	ASSERT_ALWAYS(decoded.Decompress(code), "Code of the chunk's size must decode.");
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords()) {
+		ASSERT_ALWAYS(decoded.GetVoxel(coords) == chunk.GetVoxel(coords), "Decoded chunk differ from original.");
+		ASSERT_ALWAYS(code.Get(index) == chunk.GetVoxels()[index], "Random access differ from original.");
+	}
+
+	// Runs of every length, crossing block boundaries.
+	for(size_t period : {1, 3, 15, 16, 17, 31, 32, 33, 100}) {
+		std::vector<uint8> bytes(1000);
+		std::vector<uint16> words(1000);
+		for(size_t i = 0; i < bytes.size(); ++i) bytes[i] = words[i] = (i / period) % 3;
+		std::vector<uint8> bytesOut(1000, 7);
+		std::vector<uint16> wordsOut(1000, 7);
+		RunLength<uint8>::Encode(bytes.data(), bytes.size()).Decode(bytesOut.data());
+		RunLength<uint16>::Encode(words.data(), words.size()).Decode(wordsOut.data());
+		ASSERT_ALWAYS(bytes == bytesOut, "8 bits round trip failed.");
+		ASSERT_ALWAYS(words == wordsOut, "16 bits round trip failed.");
+		ASSERT_ALWAYS(RunLength<uint8>::Encode(bytes.data(), bytes.size()).GetRunCount() == (1000 + period-1)/period, "Wrong number of runs.");
+	}
+
+	// Along the Morton curve, and from a palette.
+	ZChunk<16> zchunk(16);
+	zchunk.Procedural(layers);
+	ZChunk<16> zdecoded(16);
+	ASSERT_ALWAYS(zdecoded.Decompress(zchunk.Compress()), "Z code must decode.");
+	SparseChunk<16> sparse(16);
+	sparse.Procedural(layers);
+	SparseChunk<16> sparseDecoded(16);
+	ASSERT_ALWAYS(sparseDecoded.Decompress(sparse.Compress()), "Palette code must decode.");
+	ASSERT_ALWAYS(sparse.Compress().GetRunCount() == code.GetRunCount(), "Palette and plain chunk must give the same runs.");
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords()) {
+		ASSERT_ALWAYS(zdecoded.GetVoxel(coords) == chunk.GetVoxel(coords), "Decoded Z chunk differ from original.");
+		ASSERT_ALWAYS(sparseDecoded.GetVoxel(coords) == chunk.GetVoxel(coords), "Decoded palette chunk differ from original.");
+	}
+
+	// A code of another size is refused, and the chunk left as it was.
+	Chunk4<uint8> small(4);
+	small.Fill(1);
+	const RunLength<uint8> smallCode = small.Compress();
+	const uint64 generation = decoded.GetGeneration();
+	ASSERT_ALWAYS(!decoded.Decompress(smallCode), "Code smaller than the chunk must be refused.");
+	ASSERT_ALWAYS(!sparseDecoded.Decompress(smallCode), "Code smaller than the palette chunk must be refused.");
+	ASSERT_ALWAYS(!small.Decompress(code), "Code bigger than the chunk must be refused.");
+	ASSERT_ALWAYS(decoded.GetGeneration() == generation, "Refused code must not edit the chunk.");
+	for(auto [index, coords] : Chunk16<uint8>::VoxelArray::Coords()) {
+		ASSERT_ALWAYS(decoded.GetVoxel(coords) == chunk.GetVoxel(coords), "Refused code must not touch the chunk.");
+		ASSERT_ALWAYS(sparseDecoded.GetVoxel(coords) == chunk.GetVoxel(coords), "Refused code must not touch the palette chunk.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,214 @@
+/**
+ * \author Asso Corentin
+ * \Date May 11 2021
+ * \Desc Run length encoding of arrays.
+ */
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "Array.hpp"
+#include "PaletteArray.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace HyperV {
+
+/**
+ * Run length encoding of an array, runs follow the order of the
+ * elements in memory : along the fastest axis for S_ORDERING,
+ * along the curve for Z_ORDERING and U_ORDERING.
+ * Each run store its value, and the index after its last element,
+ * so an element can be read without decoding the whole array.
+ * Layered terrains, mostly made of long runs, shrink a lot.
+ */
+template<typename T>
+class RunLength {
+public:
+	/** Index type of the end of runs. */
+	using Index = uint32;
+
+private:
+	/** Value of each run. */
+	std::vector<T> _values;
+
+	/** Index after the last element of each run. */
+	std::vector<Index> _ends;
+
+	/**
+	 * Index after the last element equal to elements[first].
+	 * For 8 and 16 bits elements, whole blocks are compared at once.
+	 */
+	static inline size_t FindRunEnd(const T* elements, size_t first, size_t size)
+	{
+		const T value = elements[first];
+		size_t i = first+1;
+#if defined(__AVX2__)
+		if constexpr (sizeof(T) == 1 || sizeof(T) == 2) {
+			const __m256i v = (sizeof(T) == 1) ? _mm256_set1_epi8((char)value) : _mm256_set1_epi16((short)value);
+			for(; i + 32/sizeof(T) <= size; i += 32/sizeof(T)) {
+				const __m256i block = _mm256_loadu_si256((const __m256i*)(elements+i));
+				const __m256i eq = (sizeof(T) == 1) ? _mm256_cmpeq_epi8(block, v) : _mm256_cmpeq_epi16(block, v);
+				const uint32 diff = ~(uint32)_mm256_movemask_epi8(eq);
+				if(diff) return i + __builtin_ctz(diff)/sizeof(T);
+			}
+		}
+#elif defined(__SSE2__)
+		if constexpr (sizeof(T) == 1 || sizeof(T) == 2) {
+			const __m128i v = (sizeof(T) == 1) ? _mm_set1_epi8((char)value) : _mm_set1_epi16((short)value);
+			for(; i + 16/sizeof(T) <= size; i += 16/sizeof(T)) {
+				const __m128i block = _mm_loadu_si128((const __m128i*)(elements+i));
+				const __m128i eq = (sizeof(T) == 1) ? _mm_cmpeq_epi8(block, v) : _mm_cmpeq_epi16(block, v);
+				const uint32 diff = ~(uint32)_mm_movemask_epi8(eq) & 0xFFFF;
+				if(diff) return i + __builtin_ctz(diff)/sizeof(T);
+			}
+		}
+#endif
+		while(i < size && elements[i] == value) ++i;
+		return i;
+	}
+
+	/** Add a run, merged with the previous one if they have the same value. */
+	inline void Push(T value, size_t end)
+	{
+		if(!_values.empty() && _values.back() == value) _ends.back() = end;
+		else {
+			_values.push_back(value);
+			_ends.push_back(end);
+		}
+	}
+
+public:
+	/** Encode 'size' contiguous elements. */
+	static RunLength Encode(const T* elements, size_t size)
+	{
+		ASSERT(size <= std::numeric_limits<Index>::max(), "Too many elements to run length encode.");
+		RunLength code;
+		for(size_t i = 0; i < size;) {
+			const size_t end = FindRunEnd(elements, i, size);
+			code.Push(elements[i], end);
+			i = end;
+		}
+		code.ShrinkToFit();
+		return code;
+	}
+
+	/** Encode a plain array. */
+	template<IndexingMode::Enum INDEXING, size_t... DIMS>
+	static inline RunLength Encode(const NArray<INDEXING, T, DIMS...>& array)
+	{
+		static_assert(NArray<INDEXING, T, DIMS...>::SIZE <= std::numeric_limits<Index>::max(), "Too many elements to run length encode.");
+		return Encode(array.data(), NArray<INDEXING, T, DIMS...>::SIZE);
+	}
+
+	/** Encode a palette array. */
+	template<IndexingMode::Enum INDEXING, size_t... DIMS>
+	static RunLength Encode(const PaletteArray<INDEXING, T, DIMS...>& array)
+	{
+		constexpr size_t SIZE = PaletteArray<INDEXING, T, DIMS...>::SIZE;
+		static_assert(SIZE <= std::numeric_limits<Index>::max(), "Too many elements to run length encode.");
+		RunLength code;
+		if(array.IsUniform()) {
+			code.Push(array[0], SIZE);
+			return code;
+		}
+		for(size_t i = 0; i < SIZE; ++i) code.Push(array[i], i+1);
+		code.ShrinkToFit();
+		return code;
+	}
+
+	/** Decode into 'GetSize()' contiguous elements. */
+	void Decode(T* elements) const
+	{
+		size_t first = 0;
+		for(size_t r = 0; r < _values.size(); ++r) {
+			std::fill(elements + first, elements + _ends[r], _values[r]);
+			first = _ends[r];
+		}
+	}
+
+	/**
+	 * Decode into a plain array. Return false, leaving the array untouched,
+	 * if the code doesn't have as many elements, (a corrupted save).
+	 */
+	template<IndexingMode::Enum INDEXING, size_t... DIMS>
+	inline bool Decode(NArray<INDEXING, T, DIMS...>& array) const
+	{
+		if(GetSize() != NArray<INDEXING, T, DIMS...>::SIZE) return false;
+		Decode(array.data());
+		return true;
+	}
+
+	/**
+	 * Decode into a palette array, the most common value is not written twice.
+	 * Return false, leaving the array untouched, if the code doesn't have as
+	 * many elements.
+	 */
+	template<IndexingMode::Enum INDEXING, size_t... DIMS>
+	bool Decode(PaletteArray<INDEXING, T, DIMS...>& array) const
+	{
+		if(GetSize() != PaletteArray<INDEXING, T, DIMS...>::SIZE) return false;
+
+		// Value covering most elements.
+		std::vector<std::pair<T, size_t>> counts;
+		size_t first = 0;
+		for(size_t r = 0; r < _values.size(); ++r) {
+			auto it = std::find_if(counts.begin(), counts.end(), [this, r](const auto& c) { return c.first == _values[r]; });
+			if(it == counts.end()) counts.emplace_back(_values[r], _ends[r]-first);
+			else it->second += _ends[r]-first;
+			first = _ends[r];
+		}
+		const T background = std::max_element(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+			return a.second < b.second;
+		})->first;
+
+		array.Fill(background);
+		first = 0;
+		for(size_t r = 0; r < _values.size(); ++r) {
+			if(_values[r] != background)
+				for(size_t i = first; i < _ends[r]; ++i) array.Set(i, _values[r]);
+			first = _ends[r];
+		}
+		return true;
+	}
+
+	/** Read a single element, without decoding. */
+	inline T Get(size_t index) const
+	{
+		ASSERT(index < GetSize(), "Index out of bound.");
+		const size_t r = std::upper_bound(_ends.begin(), _ends.end(), index) - _ends.begin();
+		return _values[r];
+	}
+
+	/** Number of runs. */
+	inline size_t GetRunCount() const { return _values.size(); }
+
+	/** Number of encoded elements. */
+	inline size_t GetSize() const { return _ends.empty() ? 0 : _ends.back(); }
+
+	/** Memory used by the code, in bytes. */
+	inline size_t GetMemoryUsage() const
+	{
+		return sizeof(*this) + _values.capacity()*sizeof(T) + _ends.capacity()*sizeof(Index);
+	}
+
+	/** Free memory left by the encoding. */
+	inline void ShrinkToFit()
+	{
+		_values.shrink_to_fit();
+		_ends.shrink_to_fit();
+	}
+};
+
+#include "RunLength.inl"
+
+/** Unit test for RunLength class. */
+void unitests_run_length();
+
+} // namespace HyperV
\ No newline at end of file
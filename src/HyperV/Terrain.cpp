@@ -0,0 +1,48 @@
+#include "Terrain.hpp"
+
+void HyperV::unitests_terrain()
+{
+	using TestChunk = Chunk4<uint8>;
+	Terrain<TestChunk> terrain(16);
+	VoxelSet<uint8> voxelSet = VoxelSet<uint8>::GenDefaultSet();
+
+	TestChunk& a = terrain.CreateChunk({0, 0, 0});
+	TestChunk& b = terrain.CreateChunk({1, 0, 0});
+	ASSERT_ALWAYS(&terrain.CreateChunk({0, 0, 0}) == &a, "Creating an existing chunk must return it.");
+	ASSERT_ALWAYS(terrain.GetSize() == 2, "Terrain must have two chunks.");
+	ASSERT_ALWAYS(b.GetPosition()[0] == 16.0f, "Chunk must be placed on the grid.");
+
+	auto neighbors = terrain.GetNeighbors({0, 0, 0});
+	ASSERT_ALWAYS(neighbors[POS_X] == &b, "Neighbor POS_X should be chunk b.");
+	ASSERT_ALWAYS(neighbors[NEG_X] == nullptr, "Neighbor NEG_X should be absent.");
+	ASSERT_ALWAYS(neighbors[POS_Y] == nullptr, "Neighbor POS_Y should be absent.");
+	ASSERT_ALWAYS(terrain.GetNeighbors({1, 0, 0})[NEG_X] == &a, "Neighbor NEG_X should be chunk a.");
+
+	// Faces shared by two full chunks must be culled.
+	a.Fill(3);
+	b.Fill(3);
+	TriangleMesh mesh = terrain.CubicMesh({0, 0, 0}, voxelSet);
+	ASSERT_ALWAYS(mesh.getIndices().size() == (6*4*4 - 4*4)*2, "Faces on the border with b must be culled.");
+	mesh = terrain.GreedyMesh({0, 0, 0}, voxelSet);
+	ASSERT_ALWAYS(mesh.getIndices().size() == 5*2, "Greedy faces on the border with b must be culled.");
+
+	// A hole in the first layer of b show a face of a.
+	b.SetVoxel({0, 1, 1}, 0);
+	b.SetVoxel({1, 2, 2}, 0);
+	mesh = terrain.CubicMesh({0, 0, 0}, voxelSet);
+	ASSERT_ALWAYS(mesh.getIndices().size() == (6*4*4 - 4*4 + 1)*2, "Only the first layer of b must be read.");
+
+	// Without neighbors, the border is visible again.
+	ASSERT_ALWAYS(terrain.RemoveChunk({1, 0, 0}), "Chunk b must be removed.");
+	ASSERT_ALWAYS(!terrain.RemoveChunk({1, 0, 0}), "Chunk b is already removed.");
+	mesh = terrain.CubicMesh({0, 0, 0}, voxelSet);
+	ASSERT_ALWAYS(mesh.getIndices().size() == 6*4*4*2, "Border must be visible without neighbor.");
+
+	// Chunks can be moved on the grid, keeping their voxels.
+	ChunkPtr<TestChunk> released = terrain.ReleaseChunk({0, 0, 0});
+	ASSERT_ALWAYS(released.get() == &a && terrain.GetSize() == 0, "Released chunk must be given back.");
+	TestChunk& moved = terrain.InsertChunk({-2, 0, 1}, std::move(released));
+	ASSERT_ALWAYS(&moved == &a && moved.GetVoxel({0, 0, 0}) == 3, "Inserted chunk must keep its voxels.");
+	ASSERT_ALWAYS(moved.GetPosition()[0] == -32.0f && moved.GetGridCoords()[2] == 1, "Inserted chunk must be placed on the grid.");
+	ASSERT_ALWAYS(terrain.GetGridCoordsAt(Vector3f(-39.0f, 7.9f, 8.1f)) == (GridCoords<3>{-2, 0, 1}), "World position must fall in the chunk around it.");
+}
\ No newline at end of file
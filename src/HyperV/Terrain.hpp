@@ -0,0 +1,193 @@
+/**
+ * \author Asso Corentin
+ * \Date May 8 2021
+ * \Desc Definition of Terrain.
+ */
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+
+#include "Chunk.hpp"
+#include "ChunkAllocator.hpp"
+
+namespace HyperV {
+
+/**
+ * A terrain is tiled by chunks, all of the same type and world size,
+ * placed on a grid. Chunk at grid coordinates g is centered at
+ * g*chunkWorldSize.
+ * The terrain know the neighbors of each chunk, so chunks can be meshed
+ * with faces on their borders culled against the chunks next to them.
+ */
+template<typename CHUNK>
+class Terrain {
+public:
+	/** Number of dimension of the terrain. */
+	static constexpr size_t N = CHUNK::N;
+
+	using Coords = GridCoords<N>;
+	using NeighborChunks = typename CHUNK::NeighborChunks;
+
+private:
+	std::unordered_map<Coords, ChunkPtr<CHUNK>, GridCoordsHash<N>> _chunks;
+
+	/** World size of each chunk. */
+	float _chunkWorldSize;
+
+public:
+	explicit Terrain(float chunkWorldSize) : _chunkWorldSize(chunkWorldSize) {}
+
+	/** World size of each chunk. */
+	inline float GetChunkWorldSize() const { return _chunkWorldSize; }
+
+	/** Number of chunks in the terrain. */
+	inline size_t GetSize() const { return _chunks.size(); }
+
+	/** World position of the center of the chunk at given grid coordinates. */
+	inline VectorNf<N> GetChunkWorldPos(const Coords& coords) const
+	{
+		VectorNf<N> worldPos;
+		for(size_t n = 0; n < N; ++n) worldPos[n] = coords[n]*_chunkWorldSize;
+		return worldPos;
+	}
+
+	/** Grid coordinates of the chunk containing given world position. */
+	inline Coords GetGridCoordsAt(const VectorNf<N>& worldPos) const
+	{
+		Coords coords;
+		for(size_t n = 0; n < N; ++n) coords[n] = (int64)std::floor(worldPos[n]/_chunkWorldSize + 0.5f);
+		return coords;
+	}
+
+	/** Get chunk at given grid coordinates, create it if there is none. */
+	CHUNK& CreateChunk(const Coords& coords)
+	{
+		auto& chunk = _chunks[coords];
+		if(!chunk) {
+			chunk.reset(new CHUNK(_chunkWorldSize, GetChunkWorldPos(coords)));
+			chunk->SetGridCoords(coords);
+		}
+		return *chunk;
+	}
+
+	/**
+	 * Place an existing chunk at given grid coordinates, where there must be
+	 * none, its voxels are kept as they are.
+	 */
+	CHUNK& InsertChunk(const Coords& coords, ChunkPtr<CHUNK> chunk)
+	{
+		ASSERT(chunk != nullptr, "Inserting no chunk.");
+		ASSERT(chunk->GetWorldSize() == _chunkWorldSize, "Chunk world size doesn't match the terrain.");
+		auto& slot = _chunks[coords];
+		ASSERT(!slot, "There is already a chunk at those coordinates.");
+		chunk->SetPosition(GetChunkWorldPos(coords));
+		chunk->SetGridCoords(coords);
+		slot = std::move(chunk);
+		return *slot;
+	}
+
+	/** Remove chunk at given grid coordinates and give it back, nullptr if there was none. */
+	ChunkPtr<CHUNK> ReleaseChunk(const Coords& coords)
+	{
+		auto it = _chunks.find(coords);
+		if(it == _chunks.end()) return nullptr;
+		ChunkPtr<CHUNK> chunk = std::move(it->second);
+		_chunks.erase(it);
+		return chunk;
+	}
+
+	/** Remove chunk at given grid coordinates, return false if there was none. */
+	bool RemoveChunk(const Coords& coords)
+	{
+		return _chunks.erase(coords) > 0;
+	}
+
+	/** Get chunk at given grid coordinates, nullptr if there is none. */
+	inline CHUNK* GetChunk(const Coords& coords)
+	{
+		auto it = _chunks.find(coords);
+		return (it == _chunks.end()) ? nullptr : it->second.get();
+	}
+
+	/** Get chunk at given grid coordinates, nullptr if there is none. */
+	inline const CHUNK* GetChunk(const Coords& coords) const
+	{
+		auto it = _chunks.find(coords);
+		return (it == _chunks.end()) ? nullptr : it->second.get();
+	}
+
+	/** Get the 2N chunks next to the one at given grid coordinates. */
+	NeighborChunks GetNeighbors(const Coords& coords) const
+	{
+		NeighborChunks neighbors;
+		for(size_t n = 0; n < N; ++n) {
+			Coords buf = coords;
+			++buf[n];
+			neighbors[n*2+0] = GetChunk(buf);
+			buf[n] -= 2;
+			neighbors[n*2+1] = GetChunk(buf);
+		}
+		return neighbors;
+	}
+
+	/** Mesh chunk at given grid coordinates, culling faces against its neighbors. */
+	TriangleMesh CubicMesh(const Coords& coords, const VoxelSet<typename CHUNK::VoxelID>& voxelSet) const
+	{
+		const CHUNK* chunk = GetChunk(coords);
+		ASSERT(chunk != nullptr, "No chunk at those coordinates.");
+		return chunk->CubicMesh(voxelSet, GetNeighbors(coords));
+	}
+
+	/** Greedy mesh chunk at given grid coordinates, culling faces against its neighbors. */
+	TriangleMesh GreedyMesh(const Coords& coords, const VoxelSet<typename CHUNK::VoxelID>& voxelSet) const
+	{
+		const CHUNK* chunk = GetChunk(coords);
+		ASSERT(chunk != nullptr, "No chunk at those coordinates.");
+		return chunk->GreedyMesh(voxelSet, GetNeighbors(coords));
+	}
+
+	/** Opaque voxel hit by a ray, in the chunk at given grid coordinates. */
+	struct RayHit {
+		Coords chunkCoords;
+		typename CHUNK::RayHit voxel;
+	};
+
+	/**
+	 * Find the first opaque voxel pierced by a ray starting at origin,
+	 * along dir, before maxDistance (in lengths of dir), which must be
+	 * finite. The ray walk the grid of chunks with a DDA, then the voxels
+	 * of each chunk in its way, missing chunks are crossed as air.
+	 * Return false if no voxel is hit.
+	 */
+	bool Raycast(const VectorNf<N>& origin, const VectorNf<N>& dir, float maxDistance,
+		const VoxelSet<typename CHUNK::VoxelID>& voxelSet, RayHit& hit, bool skipEmptyBricks = false) const
+	{
+		ASSERT(std::isfinite(maxDistance), "Raycast must have a finite length.");
+		Coords lo, hi;
+		lo.fill(std::numeric_limits<int64>::min()/2);
+		hi.fill(std::numeric_limits<int64>::max()/2);
+		const VectorNf<N> corner = VectorNf<N>::Constant(-_chunkWorldSize*0.5f);
+		for(GridRay<N> ray(origin, dir, corner, VectorNf<N>::Constant(_chunkWorldSize), 0.0f, N, lo, hi);
+			ray.GetDistance() <= maxDistance; ray.Next()) {
+			const CHUNK* chunk = GetChunk(ray.GetCell());
+			if(chunk == nullptr || !chunk->Raycast(origin, dir, maxDistance, voxelSet, hit.voxel, skipEmptyBricks)) continue;
+			hit.chunkCoords = ray.GetCell();
+			return true;
+		}
+		return false;
+	}
+
+	/** Iterate on (grid coordinates, chunk) pairs. */
+	inline auto begin() { return _chunks.begin(); }
+	inline auto end() { return _chunks.end(); }
+	inline auto begin() const { return _chunks.begin(); }
+	inline auto end() const { return _chunks.end(); }
+};
+
+/** Unit test for Terrain class. */
+void unitests_terrain();
+
+} // namespace HyperV
\ No newline at end of file
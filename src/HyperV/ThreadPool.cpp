@@ -0,0 +1,128 @@
+#include "ThreadPool.hpp"
+
+#include <stdexcept>
+
+namespace HyperV {
+
+ThreadPool::ThreadPool(size_t nWorkers)
+{
+	for(size_t i = 0; i < nWorkers; ++i)
+		_queues.emplace_back(new Queue());
+	for(size_t i = 0; i < nWorkers; ++i)
+		_workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_stop = true;
+	}
+	_wakeUp.notify_all();
+	for(auto& worker : _workers) worker.join();
+}
+
+size_t ThreadPool::DefaultSize()
+{
+	size_t hardware = std::thread::hardware_concurrency();
+	return (hardware > 1) ? hardware-1 : 0;
+}
+
+ThreadPool& ThreadPool::GetGlobal()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::Submit(Task task)
+{
+	if(GetSize() == 0) {
+		task();
+		return;
+	}
+
+	size_t queue = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+	{
+		std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+		_queues[queue]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_pending.fetch_add(1, std::memory_order_release);
+	}
+	_wakeUp.notify_one();
+}
+
+bool ThreadPool::PopTask(size_t queue, bool back, Task& task)
+{
+	std::lock_guard<std::mutex> lock(_queues[queue]->mutex);
+	auto& tasks = _queues[queue]->tasks;
+	if(tasks.empty()) return false;
+	if(back) {
+		task = std::move(tasks.back());
+		tasks.pop_back();
+	} else {
+		task = std::move(tasks.front());
+		tasks.pop_front();
+	}
+	_pending.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+bool ThreadPool::TryRunTask(size_t worker)
+{
+	Task task;
+	const size_t n = _queues.size();
+	bool found = (worker < n) && PopTask(worker, true, task);
+	for(size_t i = 1; !found && i <= n; ++i)
+		found = PopTask((worker+i) % n, false, task);
+	if(found) task();
+	return found;
+}
+
+void ThreadPool::WorkerLoop(size_t worker)
+{
+	while(true) {
+		if(TryRunTask(worker)) continue;
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeUp.wait(lock, [this]() {
+			return _stop || _pending.load(std::memory_order_acquire) > 0;
+		});
+		if(_stop && _pending.load(std::memory_order_acquire) == 0) return;
+	}
+}
+
+} // namespace HyperV
+
+void HyperV::unitests_threadpool()
+{
+	for(size_t nWorkers : {0, 1, 3}) {
+		ThreadPool pool(nWorkers);
+		std::vector<size_t> values(1000, 0);
+		pool.ParallelFor(values.size(), [&values](size_t i) { values[i] += i; });
+		for(size_t i = 0; i < values.size(); ++i)
+			ASSERT_ALWAYS(values[i] == i, "Each iteration must run exactly once.");
+
+		// Nested loops must not dead lock.
+		std::atomic<size_t> sum(0);
+		pool.ParallelFor(8, [&pool, &sum](size_t) {
+			pool.ParallelFor(8, [&sum](size_t j) { sum += j; });
+		});
+		ASSERT_ALWAYS(sum == 8*28, "Nested parallel loops lost iterations.");
+
+		// An exception thrown by an iteration reach the caller, after the whole loop, and the pool still works.
+		bool caught = false;
+		try {
+			pool.ParallelFor(100, [](size_t i) {
+				if(i%7 == 3) throw std::runtime_error("Iteration failed.");
+			});
+		} catch(const std::runtime_error&) {
+			caught = true;
+		}
+		ASSERT_ALWAYS(caught, "Exception of an iteration must reach the caller.");
+		sum = 0;
+		pool.ParallelFor(8, [&sum](size_t j) { sum += j; });
+		ASSERT_ALWAYS(sum == 28, "Pool must work after an exception.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+ * \author Asso Corentin
+ * \Date May 5 2021
+ * \Desc Work stealing thread pool.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Util.hpp"
+
+namespace HyperV {
+
+/**
+ * Pool of worker threads.
+ * Each worker own a queue of tasks, it take tasks from the back of its
+ * own queue and when it is empty, it steal tasks from the front of the
+ * queues of the other workers.
+ * A thread waiting on ParallelFor help running tasks instead of sleeping.
+ */
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+	/** Create a pool with given number of workers, 0 mean run everything inline. */
+	explicit ThreadPool(size_t nWorkers = DefaultSize());
+
+	/** Wait for every queued tasks and join workers. */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator= (const ThreadPool&) = delete;
+
+	/** Number of hardware threads minus the one calling ParallelFor. */
+	static size_t DefaultSize();
+
+	/** Pool shared by the whole application. */
+	static ThreadPool& GetGlobal();
+
+	/** Number of workers. */
+	inline size_t GetSize() const { return _workers.size(); }
+
+	/** Queue a task, it will be run by some worker. */
+	void Submit(Task task);
+
+	/**
+	 * Call fun(i) for each i in [0, count[ and wait for all of them.
+	 * Calls can happen in any order, on any thread, the caller included.
+	 * If a call throw, the calls not started yet are skipped, and the
+	 * first exception is rethrown once every task of the loop is done.
+	 */
+	template<typename F>
+	void ParallelFor(size_t count, F fun)
+	{
+		if(GetSize() == 0 || count <= 1) {
+			for(size_t i = 0; i < count; ++i) fun(i);
+			return;
+		}
+
+		// Tasks point into this frame, so it must outlive all of them, even when fun throw.
+		std::atomic<size_t> remaining(count);
+		std::atomic<bool> failed(false);
+		std::exception_ptr error;
+		std::mutex errorMutex;
+		for(size_t i = 0; i < count; ++i) {
+			Submit([&fun, &remaining, &failed, &error, &errorMutex, i]() {
+				if(!failed.load(std::memory_order_relaxed)) {
+					try {
+						fun(i);
+					} catch(...) {
+						std::lock_guard<std::mutex> lock(errorMutex);
+						if(!error) error = std::current_exception();
+						failed.store(true, std::memory_order_relaxed);
+					}
+				}
+				remaining.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		// Help workers until every tasks of this loop are done.
+		while(remaining.load(std::memory_order_acquire) > 0) {
+			if(!TryRunTask(_workers.size())) std::this_thread::yield();
+		}
+		if(error) std::rethrow_exception(error);
+	}
+
+private:
+	/** Queue of a worker. */
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> _queues;
+	std::vector<std::thread> _workers;
+
+	/** Number of tasks inside the queues. */
+	std::atomic<size_t> _pending{0};
+
+	/** Queue receiving the next submitted task. */
+	std::atomic<size_t> _nextQueue{0};
+
+	bool _stop = false;
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeUp;
+
+	/** Pop a task from given queue, from the back if it is ours. */
+	bool PopTask(size_t queue, bool back, Task& task);
+
+	/**
+	 * Run one task, looking first at the queue of given worker,
+	 * then stealing from the others.
+	 * Return false if there was nothing to do.
+	 */
+	bool TryRunTask(size_t worker);
+
+	/** Main loop of a worker. */
+	void WorkerLoop(size_t worker);
+};
+
+/** Unit test for ThreadPool class. */
+void unitests_threadpool();
+
+} // namespace HyperV
\ No newline at end of file
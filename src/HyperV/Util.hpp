@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <array>
 #include <cassert>
 #include <type_traits>
 #include <utility>
@@ -60,8 +61,56 @@ typedef long long	int128;
 /** For stringify __LINE__ */
 #define STR(x) STR_HELPER(x)
 
-/** Assert with msg. */
-#define ASSERT(predicat, msg) HyperV::custom_assert(predicat, "\x1B[91mASSERTION_FAILED \x1B[95m: In \x1B[91m'" __FILE__ "'\x1B[95m::\x1B[91m" STR(__FUNCTION__) "\x1B[95m at line \x1B[91m" STR(__LINE__) "\x1B[95m -> \x1B[93m" msg "\033[0m")
+/**
+ * Levels of assertions, HYPERV_ASSERT_LEVEL keep every assertion
+ * up to its level, (set by CMake's HYPERV_ASSERT_LEVEL) :
+ * - ASSERT_ALWAYS : Checked in every build, for unit tests and cheap
+ *   checks on rare paths.
+ * - ASSERT : Checked in debug builds, default level without NDEBUG.
+ * - ASSERT_PARANOID : Checks inside the hottest loops, (noises, indexing,
+ *   vector maths), only when chasing a bug.
+ */
+#define HYPERV_ASSERT_LEVEL_ALWAYS 0
+#define HYPERV_ASSERT_LEVEL_DEBUG 1
+#define HYPERV_ASSERT_LEVEL_PARANOID 2
+
+#ifndef HYPERV_ASSERT_LEVEL
+#ifdef NDEBUG
+#define HYPERV_ASSERT_LEVEL HYPERV_ASSERT_LEVEL_ALWAYS
+#else
+#define HYPERV_ASSERT_LEVEL HYPERV_ASSERT_LEVEL_DEBUG
+#endif
+#endif
+
+/**
+ * What a disabled assertion become. Nothing by default, or a hint
+ * for the optimizer with HYPERV_ASSUME_ASSERTS, (the predicate must
+ * then be true and without side effects).
+ */
+#if defined(HYPERV_ASSUME_ASSERTS) && defined(__clang__)
+#define HYPERV_ASSUME(predicat) __builtin_assume(predicat)
+#elif defined(HYPERV_ASSUME_ASSERTS) && defined(__GNUC__)
+#define HYPERV_ASSUME(predicat) (static_cast<bool>(predicat) ? (void)0 : __builtin_unreachable())
+#else
+#define HYPERV_ASSUME(predicat) ((void)0)
+#endif
+
+/** Assert with msg, checked in every build. */
+#define ASSERT_ALWAYS(predicat, msg) (static_cast<bool>(predicat) ? (void)0 : HyperV::custom_assert(false, "\x1B[91mASSERTION_FAILED \x1B[95m: In \x1B[91m'" __FILE__ "'\x1B[95m::\x1B[91m" STR(__FUNCTION__) "\x1B[95m at line \x1B[91m" STR(__LINE__) "\x1B[95m -> \x1B[93m" msg "\033[0m"))
+
+/** Assert with msg, checked in debug builds. */
+#if HYPERV_ASSERT_LEVEL >= HYPERV_ASSERT_LEVEL_DEBUG
+#define ASSERT(predicat, msg) ASSERT_ALWAYS(predicat, msg)
+#else
+#define ASSERT(predicat, msg) HYPERV_ASSUME(predicat)
+#endif
+
+/** Assert with msg, checked only at paranoid level. */
+#if HYPERV_ASSERT_LEVEL >= HYPERV_ASSERT_LEVEL_PARANOID
+#define ASSERT_PARANOID(predicat, msg) ASSERT_ALWAYS(predicat, msg)
+#else
+#define ASSERT_PARANOID(predicat, msg) HYPERV_ASSUME(predicat)
+#endif
 
 namespace HyperV {
 
@@ -222,6 +271,23 @@ static inline constexpr T Div(T t) { return t; }
 /** Perfom division on parameter pack.*/
 template<typename T, typename... Pack>
 static inline constexpr T Div(T t, Pack... p) { return t / Div(p...); }
+
+/**
+ * Exclusive prefix products of parameter pack.
+ * For (a, b, c) it give {1, a, a*b}.
+ */
+template<typename T, typename... Pack>
+static inline constexpr std::array<T, sizeof...(Pack)+1> PrefixMul(T t, Pack... p)
+{
+	const std::array<T, sizeof...(Pack)+1> values = {t, ((T)p)...};
+	std::array<T, sizeof...(Pack)+1> products{};
+	T product = 1;
+	for(size_t i = 0; i < values.size(); ++i) {
+		products[i] = product;
+		product *= values[i];
+	}
+	return products;
+}
 }
 
 namespace Math {
@@ -250,7 +316,7 @@ static inline bool IsOdd(T x) {
 
 
 template<typename T>
-static inline bool IsPowerOfTwo(T x)
+static inline constexpr bool IsPowerOfTwo(T x)
 {
 	static_assert(
 		!std::is_same<T, float>() && !std::is_same<T, double>(),
@@ -259,6 +325,25 @@ static inline bool IsPowerOfTwo(T x)
 	return (x&(x-1))==0;
 }
 
+/** Constexpr floor of the logarithm in base two of an unsigned integer. */
+static inline constexpr size_t Log2(uint64 x)
+{
+	size_t l = 0;
+	while(x >>= 1) ++l;
+	return l;
+}
+
+/** Constexpr square root of a positive number, by Newton's method from above. */
+static inline constexpr double Sqrt(double x)
+{
+	double r = x > 1.0 ? x : 1.0;
+	for(;;) {
+		const double next = 0.5*(r + x/r);
+		if(!(next < r)) return r;
+		r = next;
+	}
+}
+
 /**
  * Constexpr version of pow for unsigned integer.
  * A - Base.
@@ -349,8 +434,8 @@ static inline float lenght(const T& v)
 template<size_t N, typename T, size_t I = 0>
 static inline T normalize(const T& v, const float invLenghtVec)
 {
-	ASSERT(!std::isnan(invLenghtVec), "Inverse lenght vector cannot be NaN.");
-	ASSERT(!std::isinf(invLenghtVec), "Inverse lenght vector cannot be infinite.");
+	ASSERT_PARANOID(!std::isnan(invLenghtVec), "Inverse lenght vector cannot be NaN.");
+	ASSERT_PARANOID(!std::isinf(invLenghtVec), "Inverse lenght vector cannot be infinite.");
 	if constexpr (I == N)
 		return T();
 	else {
@@ -423,8 +508,8 @@ static inline auto quintic_curve(const T& f)
 template<typename A, typename B>
 static inline auto lerp(const A& a, const B& b, float x)
 {
-	ASSERT(x >= 0, "Gradiant is lower than 0.");
-	ASSERT(x <= 1, "Gradiant is higher than 1.");
+	ASSERT_PARANOID(x >= 0, "Gradiant is lower than 0.");
+	ASSERT_PARANOID(x <= 1, "Gradiant is higher than 1.");
 	return a*(1.0f-x) + b*x;
 }
 
@@ -493,11 +578,11 @@ static inline T floor(const T& v)
 /** Fract on scalar. */
 static inline float fract(float x)
 {
-	ASSERT(!std::isnan(x), "Input is NaN.");
-	ASSERT(!std::isinf(x), "Input is infinite.");
+	ASSERT_PARANOID(!std::isnan(x), "Input is NaN.");
+	ASSERT_PARANOID(!std::isinf(x), "Input is infinite.");
 	auto f = x-floor(x);
-	ASSERT(f <= 1+EPS, "Fract cannot be higher than 1.");
-	ASSERT(f >= 0-EPS, "Fract cannot be lower than 0.");
+	ASSERT_PARANOID(f <= 1+EPS, "Fract cannot be higher than 1.");
+	ASSERT_PARANOID(f >= 0-EPS, "Fract cannot be lower than 0.");
 	return f;
 }
 
@@ -567,7 +652,7 @@ static inline T Add(const T& a, const E& b)
 		return T();
 	else {
 		auto u = Add<N, T, E, I+1>(a, b);
-		ASSERT(!WILL_OVERFLOW_ON_ADD(a[I], b[I]), "Will overflow on add.");
+		ASSERT_PARANOID(!WILL_OVERFLOW_ON_ADD(a[I], b[I]), "Will overflow on add.");
 		u[I] = a[I]+b[I];
 		return u;
 	}
@@ -582,7 +667,7 @@ static inline T Sub(const T& a, const E& b)
 		return T();
 	else {
 		auto u = Sub<N, T, E, I+1>(a, b);
-		ASSERT(!WILL_OVERFLOW_ON_SUB(a[I], b[I]), "Will overflow on sub.");
+		ASSERT_PARANOID(!WILL_OVERFLOW_ON_SUB(a[I], b[I]), "Will overflow on sub.");
 		u[I] = a[I]-b[I];
 		return u;
 	}
@@ -599,7 +684,7 @@ static inline T AddScalar(const T& a, const S& b)
 		return T();
 	else {
 		auto u = AddScalar<N,T,S,I+1>(a, b);
-		ASSERT(!WILL_OVERFLOW_ON_ADD(a[I], b), "Will overflow on add.");
+		ASSERT_PARANOID(!WILL_OVERFLOW_ON_ADD(a[I], b), "Will overflow on add.");
 		u[I] = a[I]+b;
 		return u;
 	}
@@ -616,7 +701,7 @@ static inline T SubScalar(const T& a, const S& b)
 		return T();
 	else {
 		auto u = SubScalar<N,T,S,I+1>(a, b);
-		ASSERT(!WILL_OVERFLOW_ON_SUB(a[I], b), "Will overflow on sub.");
+		ASSERT_PARANOID(!WILL_OVERFLOW_ON_SUB(a[I], b), "Will overflow on sub.");
 		u[I] = a[I] - b;
 		return u;
 	}
@@ -9,6 +9,7 @@
 #include <Core/Geometry/TriangleMesh.hpp>
 
 #include "Util.hpp"
+#include "MeshBuilder.hpp"
 #include "VoxelSet.hpp"
 
 namespace HyperV {
@@ -63,10 +64,13 @@ public:
 	void AppendCube(
 		const std::array<VOXELSET_SIZE_T, 6> neighbors,
 		const Vector3f& offset,
-		TriangleMesh& mesh,
+		MeshBuilder& mesh,
 		const float halfVoxelSize
 	) const;
 
+	/** Number of faces AppendCube will add for those neighbors. */
+	size_t CountVisibleFaces(const std::array<VOXELSET_SIZE_T, 6> neighbors) const;
+
 	/** Say if a shared face between this voxel and another is visible. */
 	bool isFaceVisible(VOXELSET_SIZE_T id) const;
 };
@@ -9,6 +9,7 @@
 #include "Array.hpp"
 #include "Voxel.hpp"
 
+#include <bitset>
 #include <limits>
 
 namespace HyperV {
@@ -35,7 +36,36 @@ private:
 	std::array<Voxel<SIZE_T>, MAX_SIZE> _voxels;
 	size_t _size = 0;
 
+	/**
+	 * Opacity of each voxel, kept in sync with _voxels.
+	 * Culling faces only need this bit, not the whole voxel.
+	 * A voxel is opaque when it is visible.
+	 */
+	std::bitset<MAX_SIZE> _opaque;
+
+	/** Voxels point to their set, they must follow it on copy. */
+	inline void BindVoxels()
+	{
+		for(size_t i = 0; i < _size; ++i) _voxels[i]._voxelset = this;
+	}
+
 public:
+	VoxelSet() {}
+
+	VoxelSet(const VoxelSet& other)
+	: _voxels(other._voxels), _size(other._size), _opaque(other._opaque)
+	{
+		BindVoxels();
+	}
+
+	VoxelSet& operator= (const VoxelSet& other)
+	{
+		_voxels = other._voxels;
+		_size = other._size;
+		_opaque = other._opaque;
+		BindVoxels();
+		return *this;
+	}
 
 	/** Generate a default voxelset. */
 	static VoxelSet GenDefaultSet()
@@ -126,6 +156,7 @@ public:
 		ASSERT(id < _size, "Out of bound id in voxelset.");
 		_voxels[id] = voxel;
 		_voxels[id]._voxelset = this;
+		_opaque[id] = voxel.visible;
 	}
 
 	/** Append voxel to the set. */
@@ -135,8 +166,23 @@ public:
 		Set(_size++, voxel);
 	}
 
+	/** Say if voxel for given id hide what is behind it. */
+	inline bool IsOpaque(SIZE_T id) const
+	{
+		return _opaque[id];
+	}
+
+	/**
+	 * Say if the face of voxel 'id' shared with voxel 'neighborID' is visible.
+	 * Only opaque voxels have faces, and they are hidden by opaque neighbors.
+	 */
+	inline bool IsFaceVisible(SIZE_T id, SIZE_T neighborID) const
+	{
+		return _opaque[id] && !_opaque[neighborID];
+	}
+
 	/** Get number of voxel stored in the set. */
-	inline SIZE_T GetSize() { return _size; }
+	inline SIZE_T GetSize() const { return _size; }
 
 	static_assert(
 		std::is_unsigned<SIZE_T>(),
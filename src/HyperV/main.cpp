@@ -11,7 +11,19 @@ using namespace HyperV;
 
 int main(int argc, char *argv[])
 {
+	HyperV::unitests_array();
+	HyperV::unitests_curve();
+	HyperV::unitests_procedural();
+	HyperV::unitests_palette_array();
+	HyperV::unitests_run_length();
+	HyperV::unitests_threadpool();
 	HyperV::unitests_chunk();
+	HyperV::unitests_terrain();
+	HyperV::unitests_chunk_pipeline();
+	HyperV::unitests_frustum();
+	HyperV::unitests_raycast();
+	HyperV::unitests_chunk_allocator();
+	HyperV::unitests_chunk_manager();
 
     //! [Creating the application]
     Ra::Gui::BaseApplication app( argc, argv );